@@ -4,6 +4,7 @@
 #include <limits>
 #include "BasicStatistics.h"
 #include "Exceptions.h"
+#include "StatisticsKernels.h"
 
 double BasicStatistics::mean(const QVector<double>& data)
 {
@@ -13,12 +14,19 @@ double BasicStatistics::mean(const QVector<double>& data)
 		THROW(StatisticsException, "Cannot calculate mean on empty data array.");
 	}
 
-	return std::accumulate(data.begin(), data.end(), 0.0) / n;
+	return StatisticsKernels::sum(data.constData(), n) / n;
 }
 
 double BasicStatistics::stdev(const QVector<double>& data)
 {
-	return stdev(data, mean(data));
+	if (data.isEmpty())
+	{
+		THROW(StatisticsException, "Cannot calculate standard deviation on empty data array.");
+	}
+
+	const int n = data.count();
+	const double mean = StatisticsKernels::sum(data.constData(), n) / n;
+	return sqrt(StatisticsKernels::sumSquaredDeviations(data.constData(), n, mean) / n);
 }
 
 double BasicStatistics::stdev(const QVector<double>& data, double mean)
@@ -29,12 +37,7 @@ double BasicStatistics::stdev(const QVector<double>& data, double mean)
 		THROW(StatisticsException, "Cannot calculate standard deviation on empty data array.");
 	}
 
-	double output = 0.0;
-	for (int i=0; i<n; ++i)
-	{
-		output += pow(data[i]-mean, 2);
-	}
-	return sqrt(output/n);
+	return sqrt(StatisticsKernels::sumSquaredDeviations(data.constData(), n, mean) / n);
 }
 
 double BasicStatistics::median(const QVector<double>& data, bool check_sorted)
@@ -67,8 +70,7 @@ double BasicStatistics::mad(const QVector<double>& data, double median)
 	{
 		devs.append(fabs(value-median));
 	}
-	std::sort(devs.begin(), devs.end());
-	return BasicStatistics::median(devs, false);
+	return quantileInPlace(devs, 0.5);
 }
 
 double BasicStatistics::q1(const QVector<double>& data, bool check_sorted)
@@ -101,6 +103,83 @@ double BasicStatistics::q3(const QVector<double>& data, bool check_sorted)
 	return data[3*n/4];
 }
 
+double BasicStatistics::quantile(const QVector<double>& data, double p)
+{
+	QVector<double> tmp = data;
+	return quantileInPlace(tmp, p);
+}
+
+double BasicStatistics::quantileInPlace(QVector<double>& data, double p)
+{
+	return quantilesInPlace(data, QVector<double>() << p)[0];
+}
+
+QVector<double> BasicStatistics::quantiles(const QVector<double>& data, const QVector<double>& probabilities)
+{
+	QVector<double> tmp = data;
+	return quantilesInPlace(tmp, probabilities);
+}
+
+QVector<double> BasicStatistics::quantilesInPlace(QVector<double>& data, const QVector<double>& probabilities)
+{
+	const int n = data.count();
+	if (n==0)
+	{
+		THROW(StatisticsException, "Cannot calculate quantile on empty data array!");
+	}
+
+	//determine the ranks of the order statistics needed for interpolation
+	QVector<int> ranks;
+	QVector<double> positions;
+	foreach(double p, probabilities)
+	{
+		if (!(p>=0.0 && p<=1.0))
+		{
+			THROW(StatisticsException, "Cannot calculate quantile for probability " + QString::number(p) + "!");
+		}
+		const double position = p * (n-1);
+		const int lower = std::min((int)position, n-1);
+		ranks << lower << std::min(lower+1, n-1);
+		positions << position;
+	}
+	std::sort(ranks.begin(), ranks.end());
+	ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+
+	selectRanks(data.data(), data.data() + n, ranks.constData(), ranks.count(), 0);
+
+	QVector<double> output;
+	output.reserve(positions.count());
+	foreach(double position, positions)
+	{
+		const int lower = std::min((int)position, n-1);
+		const int upper = std::min(lower+1, n-1);
+		output << data[lower] + (position - lower) * (data[upper] - data[lower]);
+	}
+	return output;
+}
+
+void BasicStatistics::quartiles(const QVector<double>& data, double& q1, double& median, double& q3)
+{
+	const int n = data.count();
+	if (n==0)
+	{
+		THROW(StatisticsException, "Cannot calculate quartiles on empty data array!");
+	}
+
+	QVector<double> tmp = data;
+	QVector<int> ranks;
+	ranks << n/4 << n/2 << 3*n/4;
+	if (n%2==0) ranks << n/2-1;
+	std::sort(ranks.begin(), ranks.end());
+	ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+
+	selectRanks(tmp.data(), tmp.data() + n, ranks.constData(), ranks.count(), 0);
+
+	q1 = tmp[n/4];
+	median = n%2==0 ? 0.5 * (tmp[n/2] + tmp[n/2-1]) : tmp[n/2];
+	q3 = tmp[3*n/4];
+}
+
 double BasicStatistics::correlation(const QVector<double>& x, const QVector<double>& y)
 {
 	if (x.count()!=y.count())
@@ -112,16 +191,13 @@ double BasicStatistics::correlation(const QVector<double>& x, const QVector<doub
 		THROW(StatisticsException, "Cannot calculate correlation of data arrays with zero length!");
 	}
 
-	const double x_mean = mean(x);
-	const double y_mean = mean(y);
+	const int n = x.count();
+	const double x_mean = StatisticsKernels::sum(x.constData(), n) / n;
+	const double y_mean = StatisticsKernels::sum(y.constData(), n) / n;
+	double sxx, syy, sxy;
+	StatisticsKernels::sumProducts(x.constData(), y.constData(), n, x_mean, y_mean, sxx, syy, sxy);
 
-	double sum = 0.0;
-	for(int i=0; i<x.size(); ++i)
-	{
-		sum += (x[i]-x_mean) * (y[i]-y_mean);
-	}
-
-	return sum / stdev(x, x_mean) / stdev(y, y_mean) / x.size();
+	return sxy / sqrt(sxx) / sqrt(syy);
 }
 
 bool BasicStatistics::isValidFloat(double value)
@@ -174,39 +250,15 @@ int BasicStatistics::sign(int val)
 QPair<double, double> BasicStatistics::linearRegression(const QVector<double>& x, const QVector<double>& y)
 {
 	// initializing sum of x and y values
-	int count_valid = 0;
-	double sum_x = 0.0;
-	double sum_y = 0.0;
-	for (int i=0; i<x.size(); i++)
-	{
-		if (isValidFloat(x[i]) && isValidFloat(y[i]))
-		{
-			sum_x += x[i];
-			sum_y += y[i];
-			++count_valid;
-		}
-	}
+	double sum_x, sum_y;
+	int count_valid = StatisticsKernels::validSums(x.constData(), y.constData(), x.size(), sum_x, sum_y);
 
 	// middle index of the section
 	double sxoss = sum_x / count_valid;
 
-	// initializing b
-	double slope = 0.0;
-	double st2 = 0.0;
-	for (int i=0; i<x.size(); i++)
-	{
-		if (isValidFloat(x[i]) && isValidFloat(y[i]))
-		{
-			// t is distance from the middle index
-			double t = x[i]-sxoss;
-
-			// sum of the squares of the distance from the average
-			st2 += t*t;
-
-			// b is sum of datapoints weighted by the distance
-			slope += t * y[i];
-		}
-	}
+	// st2 is the sum of the squares of the distance from the average, slope is the sum of datapoints weighted by the distance
+	double slope, st2;
+	StatisticsKernels::validRegressionSums(x.constData(), y.constData(), x.size(), sxoss, st2, slope);
 
 	// averaging b by the maximum distance from the average
 	slope /= st2;
@@ -220,19 +272,24 @@ QPair<double, double> BasicStatistics::linearRegression(const QVector<double>& x
 
 QPair<double, double> BasicStatistics::getMinMax(const QVector<double>& data)
 {
-	double min = std::numeric_limits<double>::max();
-	double max = -std::numeric_limits<double>::max();
-	foreach(double v, data)
-	{
-		if (!isValidFloat(v)) continue;
-
-		min = std::min(min, v);
-		max = std::max(max, v);
-	}
+	double min, max;
+	StatisticsKernels::validMinMax(data.constData(), data.count(), min, max);
 
 	return qMakePair(min, max);
 }
 
+void BasicStatistics::selectRanks(double* begin, double* end, const int* ranks, int rank_count, int offset)
+{
+	if (rank_count==0) return;
+
+	//select the middle rank, then the ranks left and right of it in the two partitions
+	const int middle = rank_count / 2;
+	double* nth = begin + (ranks[middle] - offset);
+	std::nth_element(begin, nth, end);
+	selectRanks(begin, nth, ranks, middle, offset);
+	selectRanks(nth + 1, end, ranks + middle + 1, rank_count - middle - 1, ranks[middle] + 1);
+}
+
 QVector<double> BasicStatistics::range(int size, double start_value, double increment)
 {
 	double next_val = start_value;
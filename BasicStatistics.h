@@ -23,6 +23,16 @@ public:
 	static double q1(const QVector<double>& data, bool check_sorted=false);
 	///Calculates the third quartile from sorted data.
 	static double q3(const QVector<double>& data, bool check_sorted=false);
+	///Calculates the @p p quantile (0<=p<=1) of unsorted data in expected linear time, interpolating linearly between order statistics (p=0.5 is the median).
+	static double quantile(const QVector<double>& data, double p);
+	///Calculates the @p p quantile like quantile(), but reorders the data instead of copying it.
+	static double quantileInPlace(QVector<double>& data, double p);
+	///Calculates several quantiles of unsorted data with one selection pass.
+	static QVector<double> quantiles(const QVector<double>& data, const QVector<double>& probabilities);
+	///Calculates several quantiles like quantiles(), but reorders the data instead of copying it.
+	static QVector<double> quantilesInPlace(QVector<double>& data, const QVector<double>& probabilities);
+	///Calculates first quartile, median and third quartile of unsorted data with one selection pass. The results are the same as q1(), median() and q3() of the sorted data.
+	static void quartiles(const QVector<double>& data, double& q1, double& median, double& q3);
 	///Calculates the correlation of two data arrays.
 	static double correlation(const QVector<double>& x, const QVector<double>& y);
 
@@ -44,6 +54,10 @@ public:
 
 	///Returns an even-spaced range of values.
 	static QVector<double> range(int size, double start_value, double increment);
+
+protected:
+	///Moves the elements with the given ranks (sorted and unique, relative to @p offset) to the positions they would have in the sorted range (introselect).
+	static void selectRanks(double* begin, double* end, const int* ranks, int rank_count, int offset);
 };
 
 #endif
@@ -0,0 +1,134 @@
+#include "CorrelationMatrix.h"
+#include "StatisticsKernels.h"
+#include "Parallel.h"
+#include "Exceptions.h"
+#include <QPair>
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include <math.h>
+
+QVector<QVector<double> > CorrelationMatrix::calculate(const QVector<QVector<double> >& data, Method method, int threads)
+{
+	const int n = data.count();
+	if (n==0) return QVector<QVector<double> >();
+	const int m = data[0].count();
+	foreach(const QVector<double>& vector, data)
+	{
+		if (vector.count()!=m)
+		{
+			THROW(StatisticsException, "Cannot calculate correlation of data arrays with different length!");
+		}
+	}
+	if (m==0)
+	{
+		THROW(StatisticsException, "Cannot calculate correlation of data arrays with zero length!");
+	}
+
+	//rank and standardize each vector once (one row per vector; std::vector because the size can exceed the int range of QVector)
+	std::vector<double> standardized(n * (size_t)m);
+	QVector<int> valid(n);
+	double* rows = standardized.data();
+	int* valid_rows = valid.data();
+	Parallel::forEach(n, [&data, method, m, rows, valid_rows](int i, int /*worker*/)
+	{
+		double* row = rows + i * (qint64)m;
+		valid_rows[i] = method==SPEARMAN ? standardize(ranks(data[i]), row) : standardize(data[i], row);
+	}, threads);
+
+	//calculate dot products of all tile pairs (upper triangle) block by block, so that the rows of both tiles stay in the cache
+	const int tiles = (n + TILE_SIZE - 1) / TILE_SIZE;
+	QVector<QPair<int, int> > tile_pairs;
+	for (int ti=0; ti<tiles; ++ti)
+	{
+		for (int tj=ti; tj<tiles; ++tj)
+		{
+			tile_pairs << qMakePair(ti, tj);
+		}
+	}
+	std::vector<double> dots(n * (size_t)n, 0.0);
+	double* out = dots.data();
+	Parallel::forEach(tile_pairs.count(), [&tile_pairs, n, m, rows, out](int t, int /*worker*/)
+	{
+		const int i_start = tile_pairs[t].first * TILE_SIZE;
+		const int i_end = std::min(i_start + TILE_SIZE, n);
+		const int j_start = tile_pairs[t].second * TILE_SIZE;
+		const int j_end = std::min(j_start + TILE_SIZE, n);
+		for (int block=0; block<m; block+=BLOCK_SIZE)
+		{
+			const int length = std::min((int)BLOCK_SIZE, m - block);
+			for (int i=i_start; i<i_end; ++i)
+			{
+				const double* x = rows + i * (qint64)m + block;
+				for (int j=std::max(i, j_start); j<j_end; ++j)
+				{
+					out[i * (qint64)n + j] += StatisticsKernels::dotProduct(x, rows + j * (qint64)m + block, length);
+				}
+			}
+		}
+	}, threads);
+
+	//create symmetric output matrix
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	QVector<QVector<double> > output(n, QVector<double>(n));
+	for (int i=0; i<n; ++i)
+	{
+		for (int j=i; j<n; ++j)
+		{
+			double value = nan;
+			if (valid[i] && valid[j])
+			{
+				value = i==j ? 1.0 : std::max(-1.0, std::min(1.0, out[i * (qint64)n + j]));
+			}
+			output[i][j] = value;
+			output[j][i] = value;
+		}
+	}
+	return output;
+}
+
+QVector<double> CorrelationMatrix::ranks(const QVector<double>& data)
+{
+	const int n = data.count();
+	QVector<int> order(n);
+	for (int i=0; i<n; ++i)
+	{
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [&data](int a, int b) { return data[a] < data[b]; });
+
+	QVector<double> output(n);
+	int start = 0;
+	while (start<n)
+	{
+		//ties get the average of their ranks
+		int end = start + 1;
+		while (end<n && data[order[end]]==data[order[start]]) ++end;
+		const double rank = 0.5 * (start + end + 1);
+		for (int i=start; i<end; ++i)
+		{
+			output[order[i]] = rank;
+		}
+		start = end;
+	}
+	return output;
+}
+
+bool CorrelationMatrix::standardize(const QVector<double>& data, double* output)
+{
+	const int m = data.count();
+	const double mean = StatisticsKernels::sum(data.constData(), m) / m;
+	const double sum_of_squares = StatisticsKernels::sumSquaredDeviations(data.constData(), m, mean);
+	if (!(sum_of_squares>0.0))
+	{
+		std::fill(output, output + m, 0.0);
+		return false;
+	}
+
+	const double factor = 1.0 / sqrt(sum_of_squares);
+	for (int i=0; i<m; ++i)
+	{
+		output[i] = (data[i] - mean) * factor;
+	}
+	return true;
+}
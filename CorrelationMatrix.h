@@ -0,0 +1,43 @@
+#ifndef CORRELATIONMATRIX_H
+#define CORRELATIONMATRIX_H
+
+#include "cppCORE_global.h"
+#include <QVector>
+
+/**
+  @brief All-pairs correlation of many data vectors of equal length (e.g. coverage profiles of samples).
+
+  Each vector is ranked (Spearman only) and standardized once, so that the correlation of two vectors is the dot product of their standardized versions.
+  The dot products are calculated in tiles of vectors and column blocks that fit into the CPU cache, using the vectorized kernel of StatisticsKernels.
+  Tiles are processed in parallel. The summation order does not depend on the number of threads.
+  The correlation of a vector without variance is NaN, like in BasicStatistics::correlation(). Invalid values (NaN, infinity) are not handled.
+*/
+class CPPCORESHARED_EXPORT CorrelationMatrix
+{
+public:
+	///Correlation measure.
+	enum Method
+	{
+		PEARSON, ///< Pearson correlation of the values
+		SPEARMAN ///< Pearson correlation of the ranks (ties get the average rank)
+	};
+
+	///Calculates the symmetric correlation matrix of the vectors. Non-positive @p threads values mean 'all cores', see Parallel.
+	static QVector<QVector<double> > calculate(const QVector<QVector<double> >& data, Method method=PEARSON, int threads=0);
+	///Returns the ranks of the values (1-based, ties get the average rank).
+	static QVector<double> ranks(const QVector<double>& data);
+
+protected:
+	///Constructor declared away.
+	CorrelationMatrix();
+
+	///Number of vectors per tile.
+	static const int TILE_SIZE = 32;
+	///Number of values per column block (32 vectors of 1024 doubles fit into 256kb).
+	static const int BLOCK_SIZE = 1024;
+
+	///Writes the standardized values (mean 0, sum of squares 1) of @p data to @p output. Returns false if the data has no variance.
+	static bool standardize(const QVector<double>& data, double* output);
+};
+
+#endif // CORRELATIONMATRIX_H
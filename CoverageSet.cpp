@@ -0,0 +1,537 @@
+#include "CoverageSet.h"
+#include "IntervalAlgebra.h"
+#include "Exceptions.h"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <string.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CPPCORE_X86_KERNELS
+#include <immintrin.h>
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+namespace
+{
+	///Function that tests positions of one chunk in its bitmap.
+	typedef void (*BitmapContains)(const quint64* bitmap, const int* positions, int count, bool* result);
+
+	void scalarBitmapContains(const quint64* bitmap, const int* positions, int count, bool* result)
+	{
+		for (int i=0; i<count; ++i)
+		{
+			const int low = positions[i] & 0xFFFF;
+			result[i] = (bitmap[low >> 6] >> (low & 63)) & 1;
+		}
+	}
+
+#ifdef CPPCORE_X86_KERNELS
+
+	///Four bools (bytes 0 or 1) for each 4-bit mask.
+	const quint32 SPREAD_BITS[16] = { 0x00000000, 0x00000001, 0x00000100, 0x00000101, 0x00010000, 0x00010001, 0x00010100, 0x00010101,
+									  0x01000000, 0x01000001, 0x01000100, 0x01000101, 0x01010000, 0x01010001, 0x01010100, 0x01010101 };
+
+	///Returns the bits of four bitmap words at the given bit offsets as a 4-bit mask (the bit is shifted into the sign bit).
+	AVX2_TARGET inline int testBits(const quint64* bitmap, __m128i words, __m128i bits)
+	{
+		const __m256i values = _mm256_i32gather_epi64(reinterpret_cast<const long long*>(bitmap), words, 8);
+		const __m256i shifts = _mm256_sub_epi64(_mm256_set1_epi64x(63), _mm256_cvtepi32_epi64(bits));
+		return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_sllv_epi64(values, shifts)));
+	}
+
+	AVX2_TARGET void avx2BitmapContains(const quint64* bitmap, const int* positions, int count, bool* result)
+	{
+		const __m256i low_mask = _mm256_set1_epi32(0xFFFF);
+		const __m256i bit_mask = _mm256_set1_epi32(63);
+		int i = 0;
+		for (; i+8<=count; i+=8)
+		{
+			const __m256i low = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(positions + i)), low_mask);
+			const __m256i words = _mm256_srli_epi32(low, 6);
+			const __m256i bits = _mm256_and_si256(low, bit_mask);
+			const int mask0 = testBits(bitmap, _mm256_castsi256_si128(words), _mm256_castsi256_si128(bits));
+			const int mask1 = testBits(bitmap, _mm256_extracti128_si256(words, 1), _mm256_extracti128_si256(bits, 1));
+			memcpy(result + i, &SPREAD_BITS[mask0], 4);
+			memcpy(result + i + 4, &SPREAD_BITS[mask1], 4);
+		}
+		_mm256_zeroupper();
+		scalarBitmapContains(bitmap, positions + i, count - i, result + i);
+	}
+
+#endif
+
+	///Selects the bitmap test for the instruction set of the CPU.
+	BitmapContains selectBitmapContains()
+	{
+#ifdef CPPCORE_X86_KERNELS
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2")) return avx2BitmapContains;
+#endif
+		return scalarBitmapContains;
+	}
+
+	///Returns the bitmap test (selected once, thread-safe).
+	BitmapContains bitmapContains()
+	{
+		static const BitmapContains selected = selectBitmapContains();
+		return selected;
+	}
+}
+
+CoverageSet::CoverageSet()
+{
+}
+
+CoverageSet::CoverageSet(const QVector<Interval>& intervals)
+{
+	//merge intervals
+	QVector<Interval> sorted = intervals;
+	std::sort(sorted.begin(), sorted.end(), MinStartPositionInterval());
+	QVector<Interval> merged;
+	IntervalAlgebra::merge(sorted, merged);
+	if (!merged.isEmpty() && merged.first().start()<0)
+	{
+		THROW(ArgumentException, "Coverage sets cannot contain negative positions: " + QString::number(merged.first().start()));
+	}
+
+	//split merged intervals into chunks (as runs)
+	Chunk current;
+	current.key = -1;
+	current.cardinality = 0;
+	foreach(const Interval& interval, merged)
+	{
+		qint64 pos = interval.start();
+		while (pos<=interval.end())
+		{
+			const int key = pos >> CHUNK_BITS;
+			const qint64 chunk_end = std::min((qint64)interval.end(), ((qint64)(key+1) << CHUNK_BITS) - 1);
+			if (key!=current.key)
+			{
+				if (current.key!=-1)
+				{
+					optimize(current);
+					appendChunk(current);
+				}
+				current.key = key;
+				current.runs.clear();
+				current.bitmap.clear();
+			}
+			appendRun(current.runs, pos & 0xFFFF, chunk_end & 0xFFFF);
+			pos = chunk_end + 1;
+		}
+	}
+	if (current.key!=-1)
+	{
+		optimize(current);
+		appendChunk(current);
+	}
+}
+
+qint64 CoverageSet::baseCount() const
+{
+	qint64 count = 0;
+	foreach(const Chunk& chunk, chunks_)
+	{
+		count += chunk.cardinality;
+	}
+	return count;
+}
+
+qint64 CoverageSet::memoryUsage() const
+{
+	qint64 bytes = sizeof(CoverageSet) + chunk_index_.count() * sizeof(int);
+	foreach(const Chunk& chunk, chunks_)
+	{
+		bytes += sizeof(Chunk) + chunk.runs.count() * sizeof(quint16) + chunk.bitmap.count() * sizeof(quint64);
+	}
+	return bytes;
+}
+
+bool CoverageSet::contains(int pos) const
+{
+	if (pos<0) return false;
+
+	const Chunk* c = chunk(pos >> CHUNK_BITS);
+	return c!=0 && chunkContains(*c, pos & 0xFFFF);
+}
+
+void CoverageSet::contains(const int* positions, int count, bool* result) const
+{
+	const BitmapContains testBitmap = bitmapContains();
+	int i = 0;
+	while (i<count)
+	{
+		if (positions[i]<0)
+		{
+			result[i++] = false;
+			continue;
+		}
+
+		//process the following positions of the same chunk together
+		const int key = positions[i] >> CHUNK_BITS;
+		int end = i + 1;
+		while (end<count && positions[end]>=0 && (positions[end] >> CHUNK_BITS)==key) ++end;
+
+		const Chunk* c = chunk(key);
+		if (c==0)
+		{
+			std::fill(result + i, result + end, false);
+		}
+		else if (!c->bitmap.isEmpty())
+		{
+			testBitmap(c->bitmap.constData(), positions + i, end - i, result + i);
+		}
+		else
+		{
+			for (int j=i; j<end; ++j)
+			{
+				result[j] = chunkContains(*c, positions[j] & 0xFFFF);
+			}
+		}
+		i = end;
+	}
+}
+
+void CoverageSet::contains(const QVector<int>& positions, QVector<bool>& result) const
+{
+	result.resize(positions.count());
+	contains(positions.constData(), positions.count(), result.data());
+}
+
+qint64 CoverageSet::overlapLength(int start, int end) const
+{
+	if (end<0 || start>end) return 0;
+	start = std::max(start, 0);
+
+	qint64 count = 0;
+	const int first_key = start >> CHUNK_BITS;
+	const int last_key = end >> CHUNK_BITS;
+	for (int key=first_key; key<=last_key; ++key)
+	{
+		const Chunk* c = chunk(key);
+		if (c==0) continue;
+
+		const int first = key==first_key ? (start & 0xFFFF) : 0;
+		const int last = key==last_key ? (end & 0xFFFF) : 0xFFFF;
+		count += (first==0 && last==0xFFFF) ? c->cardinality : chunkOverlap(*c, first, last);
+	}
+	return count;
+}
+
+CoverageSet CoverageSet::unite(const CoverageSet& other) const
+{
+	CoverageSet output;
+	int i = 0;
+	int j = 0;
+	while (i<chunks_.count() || j<other.chunks_.count())
+	{
+		if (j==other.chunks_.count() || (i<chunks_.count() && chunks_[i].key<other.chunks_[j].key))
+		{
+			output.appendChunk(chunks_[i]);
+			++i;
+		}
+		else if (i==chunks_.count() || other.chunks_[j].key<chunks_[i].key)
+		{
+			output.appendChunk(other.chunks_[j]);
+			++j;
+		}
+		else
+		{
+			const Chunk& a = chunks_[i];
+			const Chunk& b = other.chunks_[j];
+			Chunk chunk;
+			chunk.key = a.key;
+			if (a.bitmap.isEmpty() && b.bitmap.isEmpty())
+			{
+				//merge runs
+				int k = 0;
+				int l = 0;
+				while (k<a.runs.count() || l<b.runs.count())
+				{
+					const QVector<quint16>& runs = (l==b.runs.count() || (k<a.runs.count() && a.runs[k]<=b.runs[l])) ? a.runs : b.runs;
+					int& index = (&runs==&a.runs) ? k : l;
+					appendRun(chunk.runs, runs[index], runs[index+1]);
+					index += 2;
+				}
+			}
+			else
+			{
+				chunk.bitmap = chunkBitmap(a);
+				const QVector<quint64> bitmap = chunkBitmap(b);
+				for (int w=0; w<BITMAP_WORDS; ++w)
+				{
+					chunk.bitmap[w] |= bitmap[w];
+				}
+			}
+			optimize(chunk);
+			output.appendChunk(chunk);
+			++i;
+			++j;
+		}
+	}
+	return output;
+}
+
+CoverageSet CoverageSet::intersect(const CoverageSet& other) const
+{
+	CoverageSet output;
+	int i = 0;
+	int j = 0;
+	while (i<chunks_.count() && j<other.chunks_.count())
+	{
+		if (chunks_[i].key<other.chunks_[j].key)
+		{
+			++i;
+			continue;
+		}
+		if (other.chunks_[j].key<chunks_[i].key)
+		{
+			++j;
+			continue;
+		}
+
+		const Chunk& a = chunks_[i];
+		const Chunk& b = other.chunks_[j];
+		Chunk chunk;
+		chunk.key = a.key;
+		if (a.bitmap.isEmpty() && b.bitmap.isEmpty())
+		{
+			//intersect runs (the run that ends first cannot overlap further runs)
+			int k = 0;
+			int l = 0;
+			while (k<a.runs.count() && l<b.runs.count())
+			{
+				const int first = std::max(a.runs[k], b.runs[l]);
+				const int last = std::min(a.runs[k+1], b.runs[l+1]);
+				if (first<=last) appendRun(chunk.runs, first, last);
+				if (a.runs[k+1]<b.runs[l+1]) k += 2;
+				else l += 2;
+			}
+		}
+		else
+		{
+			chunk.bitmap = chunkBitmap(a);
+			const QVector<quint64> bitmap = chunkBitmap(b);
+			for (int w=0; w<BITMAP_WORDS; ++w)
+			{
+				chunk.bitmap[w] &= bitmap[w];
+			}
+		}
+		optimize(chunk);
+		if (chunk.cardinality>0)
+		{
+			output.appendChunk(chunk);
+		}
+		++i;
+		++j;
+	}
+	return output;
+}
+
+QVector<Interval> CoverageSet::intervals() const
+{
+	QVector<Interval> output;
+	foreach(const Chunk& chunk, chunks_)
+	{
+		const QVector<quint16> runs = chunk.bitmap.isEmpty() ? chunk.runs : bitmapRuns(chunk.bitmap);
+		const int offset = chunk.key << CHUNK_BITS;
+		for (int r=0; r<runs.count(); r+=2)
+		{
+			const int start = offset + runs[r];
+			const int end = offset + runs[r+1];
+
+			//merge runs that continue in the next chunk
+			if (!output.isEmpty() && output.last().end()+1==start)
+			{
+				output.last() = Interval(output.last().start(), end, -1);
+			}
+			else
+			{
+				output.append(Interval(start, end, -1));
+			}
+		}
+	}
+	return output;
+}
+
+void CoverageSet::appendRun(QVector<quint16>& runs, int first, int last)
+{
+	if (!runs.isEmpty() && runs.last()+1>=first)
+	{
+		runs.last() = std::max((int)runs.last(), last);
+	}
+	else
+	{
+		runs.append(first);
+		runs.append(last);
+	}
+}
+
+void CoverageSet::setBits(quint64* bitmap, int first, int last)
+{
+	const int first_word = first >> 6;
+	const int last_word = last >> 6;
+	const quint64 first_mask = ~0ULL << (first & 63);
+	const quint64 last_mask = ~0ULL >> (63 - (last & 63));
+	if (first_word==last_word)
+	{
+		bitmap[first_word] |= first_mask & last_mask;
+		return;
+	}
+	bitmap[first_word] |= first_mask;
+	for (int w=first_word+1; w<last_word; ++w)
+	{
+		bitmap[w] = ~0ULL;
+	}
+	bitmap[last_word] |= last_mask;
+}
+
+int CoverageSet::countBits(const quint64* bitmap, int first, int last)
+{
+	const int first_word = first >> 6;
+	const int last_word = last >> 6;
+	const quint64 first_mask = ~0ULL << (first & 63);
+	const quint64 last_mask = ~0ULL >> (63 - (last & 63));
+	if (first_word==last_word)
+	{
+		return qPopulationCount(bitmap[first_word] & first_mask & last_mask);
+	}
+	int count = qPopulationCount(bitmap[first_word] & first_mask);
+	for (int w=first_word+1; w<last_word; ++w)
+	{
+		count += qPopulationCount(bitmap[w]);
+	}
+	return count + qPopulationCount(bitmap[last_word] & last_mask);
+}
+
+QVector<quint16> CoverageSet::bitmapRuns(const QVector<quint64>& bitmap)
+{
+	QVector<quint16> runs;
+	int start = -1;
+	for (int w=0; w<BITMAP_WORDS; ++w)
+	{
+		const quint64 word = bitmap[w];
+
+		//skip words without run boundaries
+		if ((start==-1 && word==0ULL) || (start!=-1 && word==~0ULL)) continue;
+
+		for (int b=0; b<64; ++b)
+		{
+			const bool set = (word >> b) & 1;
+			if (set && start==-1)
+			{
+				start = (w << 6) + b;
+			}
+			else if (!set && start!=-1)
+			{
+				runs.append(start);
+				runs.append((w << 6) + b - 1);
+				start = -1;
+			}
+		}
+	}
+	if (start!=-1)
+	{
+		runs.append(start);
+		runs.append(0xFFFF);
+	}
+	return runs;
+}
+
+QVector<quint64> CoverageSet::chunkBitmap(const Chunk& chunk)
+{
+	if (!chunk.bitmap.isEmpty()) return chunk.bitmap;
+
+	QVector<quint64> bitmap(BITMAP_WORDS, 0ULL);
+	for (int r=0; r<chunk.runs.count(); r+=2)
+	{
+		setBits(bitmap.data(), chunk.runs[r], chunk.runs[r+1]);
+	}
+	return bitmap;
+}
+
+void CoverageSet::optimize(Chunk& chunk)
+{
+	if (!chunk.bitmap.isEmpty())
+	{
+		QVector<quint16> runs = bitmapRuns(chunk.bitmap);
+		if (runs.count()/2<=MAX_RUNS)
+		{
+			chunk.runs = runs;
+			chunk.bitmap.clear();
+		}
+	}
+	else if (chunk.runs.count()/2>MAX_RUNS)
+	{
+		chunk.bitmap = chunkBitmap(chunk);
+		chunk.runs.clear();
+	}
+
+	if (chunk.bitmap.isEmpty())
+	{
+		chunk.cardinality = 0;
+		for (int r=0; r<chunk.runs.count(); r+=2)
+		{
+			chunk.cardinality += chunk.runs[r+1] - chunk.runs[r] + 1;
+		}
+	}
+	else
+	{
+		chunk.cardinality = countBits(chunk.bitmap.constData(), 0, 0xFFFF);
+	}
+}
+
+int CoverageSet::chunkOverlap(const Chunk& chunk, int first, int last)
+{
+	if (!chunk.bitmap.isEmpty())
+	{
+		return countBits(chunk.bitmap.constData(), first, last);
+	}
+
+	//binary search for the first run that ends at or after the first position
+	int lower = 0;
+	int upper = chunk.runs.count() / 2;
+	while (lower<upper)
+	{
+		const int middle = (lower + upper) / 2;
+		if (chunk.runs[2*middle+1]<first) lower = middle + 1;
+		else upper = middle;
+	}
+
+	int count = 0;
+	for (int r=2*lower; r<chunk.runs.count() && chunk.runs[r]<=last; r+=2)
+	{
+		count += std::min((int)chunk.runs[r+1], last) - std::max((int)chunk.runs[r], first) + 1;
+	}
+	return count;
+}
+
+bool CoverageSet::chunkContains(const Chunk& chunk, int low)
+{
+	if (!chunk.bitmap.isEmpty())
+	{
+		return (chunk.bitmap[low >> 6] >> (low & 63)) & 1;
+	}
+
+	//binary search for the last run that starts at or before the position
+	int lower = 0;
+	int upper = chunk.runs.count() / 2;
+	while (lower<upper)
+	{
+		const int middle = (lower + upper) / 2;
+		if (chunk.runs[2*middle]<=low) lower = middle + 1;
+		else upper = middle;
+	}
+	return lower>0 && chunk.runs[2*lower-1]>=low;
+}
+
+void CoverageSet::appendChunk(const Chunk& chunk)
+{
+	if (chunk.key>=chunk_index_.count())
+	{
+		chunk_index_.resize(chunk.key + 1);
+		std::fill(chunk_index_.begin() + (chunks_.isEmpty() ? 0 : chunks_.last().key + 1), chunk_index_.end(), -1);
+	}
+	chunk_index_[chunk.key] = chunks_.count();
+	chunks_.append(chunk);
+}
@@ -0,0 +1,112 @@
+#ifndef COVERAGESET_H
+#define COVERAGESET_H
+
+#include "cppCORE_global.h"
+#include "IntervalTree.h"
+#include <QVector>
+
+/**
+  @brief Compressed set of covered positions of one sequence (roaring-style).
+
+  Positions are split into chunks of 65536 positions. Each non-empty chunk is stored either as a sorted list of runs (first and last position
+  relative to the chunk start, 4 bytes per run), or as a bitmap (8kb), whichever is smaller. Dense target sets like exome capture regions
+  compress well, and membership and overlap-length queries take constant time per chunk (plus a binary search in run chunks).
+  Union and intersection work chunk by chunk, with word-wise bit operations for bitmaps.
+  Positions must be non-negative. Intervals are closed, i.e. start and end position are part of the interval.
+*/
+class CPPCORESHARED_EXPORT CoverageSet
+{
+public:
+	///Default constructor for an empty set.
+	CoverageSet();
+	///Constructor that creates the set of positions covered by the intervals (unsorted and overlapping intervals are allowed). Use IntervalTree::allIntervals() to convert a tree.
+	CoverageSet(const QVector<Interval>& intervals);
+
+	///Returns if the set is empty.
+	bool isEmpty() const
+	{
+		return chunks_.isEmpty();
+	}
+	///Returns the number of covered positions.
+	qint64 baseCount() const;
+	///Returns the approximate memory usage in bytes.
+	qint64 memoryUsage() const;
+
+	///Returns if a position is covered.
+	bool contains(int pos) const;
+	///Checks the membership of @p count positions and stores the results in @p result. Positions do not need to be sorted, but consecutive positions in the same chunk are processed together.
+	///For bitmap chunks, they are tested eight at a time with AVX2 gathers if the CPU supports it (selected once at run-time, like in StatisticsKernels).
+	void contains(const int* positions, int count, bool* result) const;
+	///Convenience overload of the batched membership check.
+	void contains(const QVector<int>& positions, QVector<bool>& result) const;
+	///Returns the number of covered positions in [start, end].
+	qint64 overlapLength(int start, int end) const;
+	///Returns if any position in [start, end] is covered.
+	bool overlaps(int start, int end) const
+	{
+		return overlapLength(start, end)>0;
+	}
+
+	///Returns the union with another set.
+	CoverageSet unite(const CoverageSet& other) const;
+	///Returns the intersection with another set.
+	CoverageSet intersect(const CoverageSet& other) const;
+	///Returns the covered positions as merged intervals sorted by position (value is -1).
+	QVector<Interval> intervals() const;
+
+protected:
+	///Positions per chunk (as number of bits), words per bitmap and maximum number of runs in a run chunk.
+	enum
+	{
+		CHUNK_BITS = 16,
+		BITMAP_WORDS = 1024,
+		MAX_RUNS = 2048
+	};
+
+	///Chunk of 65536 positions.
+	struct Chunk
+	{
+		///Chunk number, i.e. position >> CHUNK_BITS
+		int key;
+		///Number of covered positions
+		int cardinality;
+		///Runs as pairs of first and last position in the chunk (only used if the bitmap is empty)
+		QVector<quint16> runs;
+		///Bitmap with one bit per position (empty for run chunks)
+		QVector<quint64> bitmap;
+	};
+
+	///Appends a run to a run list (runs are appended in position order). Adjacent runs are merged.
+	static void appendRun(QVector<quint16>& runs, int first, int last);
+	///Sets the bits of [first, last] in a bitmap.
+	static void setBits(quint64* bitmap, int first, int last);
+	///Returns the number of set bits of [first, last] in a bitmap.
+	static int countBits(const quint64* bitmap, int first, int last);
+	///Returns the runs of a bitmap.
+	static QVector<quint16> bitmapRuns(const QVector<quint64>& bitmap);
+	///Returns the bitmap of a chunk (converted if the chunk is a run chunk).
+	static QVector<quint64> chunkBitmap(const Chunk& chunk);
+	///Chooses the smaller representation for a chunk and updates the cardinality.
+	static void optimize(Chunk& chunk);
+	///Returns the number of covered positions of [first, last] in a chunk.
+	static int chunkOverlap(const Chunk& chunk, int first, int last);
+	///Returns if a position is covered in a chunk.
+	static bool chunkContains(const Chunk& chunk, int low);
+
+	///Appends a chunk and updates the chunk lookup table.
+	void appendChunk(const Chunk& chunk);
+	///Returns the chunk of a position, or null if the chunk is empty.
+	const Chunk* chunk(int key) const
+	{
+		if (key<0 || key>=chunk_index_.count()) return 0;
+		const int i = chunk_index_[key];
+		return i==-1 ? 0 : &chunks_[i];
+	}
+
+	///Non-empty chunks sorted by key
+	QVector<Chunk> chunks_;
+	///Chunk index of each key (-1 if the chunk is empty)
+	QVector<int> chunk_index_;
+};
+
+#endif // COVERAGESET_H
@@ -0,0 +1,234 @@
+#include "DynamicIntervalTree.h"
+#include <algorithm>
+
+namespace
+{
+	///Orders intervals by start position, end position and value.
+	bool lessByPositionAndValue(const Interval& a, const Interval& b)
+	{
+		if (a.start()!=b.start()) return a.start() < b.start();
+		if (a.end()!=b.end()) return a.end() < b.end();
+		return a.value() < b.value();
+	}
+}
+
+DynamicIntervalTree::DynamicIntervalTree()
+	: root_(-1)
+	, count_(0)
+	, random_state_(2463534242u)
+{
+}
+
+void DynamicIntervalTree::build(const QVector<Interval>& intervals)
+{
+	clear();
+
+	QVector<Interval> sorted = intervals;
+	std::sort(sorted.begin(), sorted.end(), lessByPositionAndValue);
+
+	//create the Cartesian tree of the node priorities with a stack of the right-most path (linear time)
+	nodes_.reserve(sorted.count());
+	QVector<int> path;
+	foreach(const Interval& interval, sorted)
+	{
+		int node = createNode(interval);
+		int last_popped = -1;
+		while (!path.isEmpty() && nodes_[path.last()].priority<nodes_[node].priority)
+		{
+			last_popped = path.takeLast();
+		}
+		nodes_[node].left = last_popped;
+		if (!path.isEmpty())
+		{
+			nodes_[path.last()].right = node;
+		}
+		path.append(node);
+	}
+	root_ = path.isEmpty() ? -1 : path.first();
+	count_ = sorted.count();
+
+	updateSubTree(root_);
+}
+
+void DynamicIntervalTree::insert(const Interval& interval)
+{
+	int node = createNode(interval);
+	int left, right;
+	split(root_, interval, false, left, right);
+	root_ = merge(merge(left, node), right);
+	++count_;
+}
+
+bool DynamicIntervalTree::erase(const Interval& interval)
+{
+	//split into nodes before the interval, nodes equal to the interval and nodes after the interval
+	int left, rest, equal, right;
+	split(root_, interval, false, left, rest);
+	split(rest, interval, true, equal, right);
+
+	bool found = (equal!=-1);
+	if (found)
+	{
+		int erased = equal;
+		equal = merge(nodes_[erased].left, nodes_[erased].right);
+		free_nodes_.append(erased);
+		--count_;
+	}
+
+	root_ = merge(merge(left, equal), right);
+	return found;
+}
+
+void DynamicIntervalTree::clear()
+{
+	nodes_.clear();
+	free_nodes_.clear();
+	root_ = -1;
+	count_ = 0;
+}
+
+void DynamicIntervalTree::overlappingIntervals(int start, int stop, QVector<int>& matches, bool stop_at_first_match) const
+{
+	matches.clear();
+	findOverlappingIntervals(root_, start, stop, matches, stop_at_first_match);
+}
+
+void DynamicIntervalTree::allIntervals(QVector<Interval>& intervals) const
+{
+	intervals.clear();
+	intervals.reserve(count_);
+	collectIntervals(root_, intervals);
+}
+
+int DynamicIntervalTree::createNode(const Interval& interval)
+{
+	Node node;
+	node.start = interval.start();
+	node.end = interval.end();
+	node.value = interval.value();
+	node.max_end = interval.end();
+	node.priority = nextPriority();
+	node.left = -1;
+	node.right = -1;
+
+	if (!free_nodes_.isEmpty())
+	{
+		int index = free_nodes_.takeLast();
+		nodes_[index] = node;
+		return index;
+	}
+
+	nodes_.append(node);
+	return nodes_.count() - 1;
+}
+
+void DynamicIntervalTree::update(int node)
+{
+	Node& n = nodes_[node];
+	n.max_end = n.end;
+	if (n.left!=-1) n.max_end = std::max(n.max_end, nodes_[n.left].max_end);
+	if (n.right!=-1) n.max_end = std::max(n.max_end, nodes_[n.right].max_end);
+}
+
+void DynamicIntervalTree::updateSubTree(int node)
+{
+	if (node==-1) return;
+
+	updateSubTree(nodes_[node].left);
+	updateSubTree(nodes_[node].right);
+	update(node);
+}
+
+bool DynamicIntervalTree::before(int node, const Interval& interval, bool or_equal) const
+{
+	const Node& n = nodes_[node];
+	if (n.start!=interval.start()) return n.start < interval.start();
+	if (n.end!=interval.end()) return n.end < interval.end();
+	if (n.value!=interval.value()) return n.value < interval.value();
+	return or_equal;
+}
+
+void DynamicIntervalTree::split(int node, const Interval& interval, bool or_equal, int& left, int& right)
+{
+	if (node==-1)
+	{
+		left = -1;
+		right = -1;
+		return;
+	}
+
+	int sub_left, sub_right;
+	if (before(node, interval, or_equal))
+	{
+		split(nodes_[node].right, interval, or_equal, sub_left, sub_right);
+		nodes_[node].right = sub_left;
+		update(node);
+		left = node;
+		right = sub_right;
+	}
+	else
+	{
+		split(nodes_[node].left, interval, or_equal, sub_left, sub_right);
+		nodes_[node].left = sub_right;
+		update(node);
+		left = sub_left;
+		right = node;
+	}
+}
+
+int DynamicIntervalTree::merge(int left, int right)
+{
+	if (left==-1) return right;
+	if (right==-1) return left;
+
+	//the node with the higher priority becomes the root
+	if (nodes_[left].priority>nodes_[right].priority)
+	{
+		nodes_[left].right = merge(nodes_[left].right, right);
+		update(left);
+		return left;
+	}
+
+	nodes_[right].left = merge(left, nodes_[right].left);
+	update(right);
+	return right;
+}
+
+bool DynamicIntervalTree::findOverlappingIntervals(int node, int start, int stop, QVector<int>& matches, bool stop_at_first_match) const
+{
+	//no interval of the sub-tree reaches the query
+	if (node==-1 || nodes_[node].max_end<start) return true;
+
+	const Node& n = nodes_[node];
+	if (!findOverlappingIntervals(n.left, start, stop, matches, stop_at_first_match)) return false;
+
+	//this node and the right sub-tree start after the query
+	if (n.start>stop) return true;
+
+	if (n.end>=start)
+	{
+		matches.append(n.value);
+		if (stop_at_first_match) return false;
+	}
+
+	return findOverlappingIntervals(n.right, start, stop, matches, stop_at_first_match);
+}
+
+void DynamicIntervalTree::collectIntervals(int node, QVector<Interval>& intervals) const
+{
+	if (node==-1) return;
+
+	const Node& n = nodes_[node];
+	collectIntervals(n.left, intervals);
+	intervals.append(Interval(n.start, n.end, n.value));
+	collectIntervals(n.right, intervals);
+}
+
+quint32 DynamicIntervalTree::nextPriority()
+{
+	//xorshift32
+	random_state_ ^= random_state_ << 13;
+	random_state_ ^= random_state_ >> 17;
+	random_state_ ^= random_state_ << 5;
+	return random_state_;
+}
@@ -0,0 +1,93 @@
+#ifndef DYNAMICINTERVALTREE_H
+#define DYNAMICINTERVALTREE_H
+
+#include "cppCORE_global.h"
+#include "IntervalTree.h"
+#include <QVector>
+
+/**
+  @brief Interval tree that supports inserting and erasing intervals.
+
+  In contrast to IntervalTree, which cannot be changed after its initialization, this tree is a treap (a binary search tree
+  that is balanced by random node priorities) ordered by start position, end position and value. Each node stores the maximum
+  end position of its sub-tree, so insert(), erase() and overlappingIntervals() take O(log(n)) expected time (plus the number of matches).
+  build() creates the tree from an interval array in linear time after sorting.
+  Nodes are stored in one array owned by the tree and the nodes of erased intervals are re-used.
+  Intervals are closed, i.e. start and end position are part of the interval.
+*/
+class CPPCORESHARED_EXPORT DynamicIntervalTree
+{
+public:
+	///Default constructor for an empty tree.
+	DynamicIntervalTree();
+
+	///Replaces the content of the tree by the given intervals (bulk-load).
+	void build(const QVector<Interval>& intervals);
+	///Inserts an interval. The interval value is reported by the queries.
+	void insert(const Interval& interval);
+	///Erases one interval with the same start, end and value. Returns false if no such interval is contained.
+	bool erase(const Interval& interval);
+	///Removes all intervals.
+	void clear();
+
+	///Returns the number of intervals.
+	int count() const
+	{
+		return count_;
+	}
+	///Returns true if the tree is empty.
+	bool isEmpty() const
+	{
+		return count_==0;
+	}
+
+	///Determines the values of the intervals overlapping [start, stop], ordered by start position. If stop_at_first_match is true, only the first overlapping interval is returned.
+	void overlappingIntervals(int start, int stop, QVector<int>& matches, bool stop_at_first_match=false) const;
+	///Returns all intervals ordered by start position.
+	void allIntervals(QVector<Interval>& intervals) const;
+
+protected:
+	///Tree node. Children are indices in the node array, -1 means 'no child'.
+	struct Node
+	{
+		int start;
+		int end;
+		int value;
+		int max_end;
+		quint32 priority;
+		int left;
+		int right;
+	};
+
+	///Creates a node (re-using erased nodes) and returns its index.
+	int createNode(const Interval& interval);
+	///Updates the maximum end position of a node from its children.
+	void update(int node);
+	///Updates the maximum end positions of all nodes of a sub-tree (bottom-up).
+	void updateSubTree(int node);
+	///Returns if the node is ordered before the interval. If @p or_equal is true, equal nodes are also considered to be before the interval.
+	bool before(int node, const Interval& interval, bool or_equal) const;
+	///Splits a sub-tree into the nodes before the interval (left) and the rest (right).
+	void split(int node, const Interval& interval, bool or_equal, int& left, int& right);
+	///Merges two sub-trees, where all nodes of @p left are before the nodes of @p right. Returns the new root.
+	int merge(int left, int right);
+	///Recursive part of overlappingIntervals(). Returns false if the search should stop.
+	bool findOverlappingIntervals(int node, int start, int stop, QVector<int>& matches, bool stop_at_first_match) const;
+	///Recursive part of allIntervals().
+	void collectIntervals(int node, QVector<Interval>& intervals) const;
+	///Returns the next random node priority.
+	quint32 nextPriority();
+
+	///Node array
+	QVector<Node> nodes_;
+	///Indices of erased nodes
+	QVector<int> free_nodes_;
+	///Root node index
+	int root_;
+	///Number of intervals
+	int count_;
+	///State of the random number generator for the node priorities
+	quint32 random_state_;
+};
+
+#endif // DYNAMICINTERVALTREE_H
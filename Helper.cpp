@@ -1,29 +1,22 @@
 #include "Helper.h"
+#include "RandomGenerator.h"
 #include "cmath"
-#include "time.h"
 #include <QDir>
-#include <QCoreApplication>
 #include <QDateTime>
 
 double Helper::randomNumber(double min, double max)
 {
-	double r = (double)rand() / (double)RAND_MAX;
-	return min + r * (max - min);
+	return RandomGenerator::threadInstance().uniform(min, max);
 }
 
 QString Helper::randomString(int length, const QString& chars)
 {
-	//initialize random number generator
-	int seconds = time(NULL);
-	int milliseconds = QTime::currentTime().msec();
-	int process_id = QCoreApplication::applicationPid();
-	srand(seconds + milliseconds + process_id + rand());
+	RandomGenerator& generator = RandomGenerator::threadInstance();
 
-	//create random string
 	QString output;
 	for (int i=0; i<length; ++i)
 	{
-        output.append(chars[rand() % chars.length()]);
+		output.append(chars[generator.integer(0, chars.length()-1)]);
 	}
 	return output;
 }
@@ -14,7 +14,7 @@
 class CPPCORESHARED_EXPORT Helper
 {
 public:
-	///Returns a random number in the given range
+	///Returns a uniformly distributed random number in the half-open range [min, max)
 	static double randomNumber(double min, double max);
 	///Returns a random string.
 	static QString randomString(int length, const QString& chars="0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz");
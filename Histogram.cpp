@@ -75,7 +75,7 @@ int Histogram::binCount() const
 	return bins_.size();
 }
 
-int Histogram::binSum()
+double Histogram::binSum()
 {
 	return bin_sum_;
 }
@@ -126,6 +126,17 @@ void Histogram::inc(double val, bool ignore_bounds_errors)
 	bin_sum_ += 1;
 }
 
+void Histogram::incBy(double val, double count, bool ignore_bounds_errors)
+{
+	if (ignore_bounds_errors)
+	{
+		val = BasicStatistics::bound(val, min_, max_);
+	}
+
+	bins_[binIndex(val)]+=count;
+	bin_sum_ += count;
+}
+
 void Histogram::inc(const QVector<double>& data, bool ignore_bounds_errors)
 {
 	for (int i=0; i<data.size(); ++i)
@@ -16,6 +16,8 @@ public:
 	void inc(double val, bool ignore_bounds_errors = false);
 	/// Increases the bin corresponding to the values in @p data by one
 	void inc(const QVector<double>& data, bool ignore_bounds_errors = false);
+	/// Increases the bin corresponding to value @p val by @p count (e.g. the number of positions with a given depth)
+	void incBy(double val, double count, bool ignore_bounds_errors = false);
 
 	/// Returns the lower bound position (x-axis)
 	double min() const;
@@ -25,8 +27,8 @@ public:
 	double binSize() const;
 	/// Returns the number of bins
 	int binCount() const;
-	/// Returns the sum of all bins (i.e. the number of data points added)
-	int binSum();
+	/// Returns the sum of all bins (i.e. the number of data points added). It is a double, because sums of incBy() counts can exceed the int range.
+	double binSum();
 
 	/// Returns the bin a given position belongs to
 	int binIndex(double val) const;
@@ -60,7 +62,7 @@ protected:
 	/// bin size
 	double bin_size_;
 	/// sum of all bins (used for percentage mode)
-	int bin_sum_;
+	double bin_sum_;
 
 	/// vector of bins
 	QVector<double> bins_;
@@ -0,0 +1,394 @@
+#include "IntervalAlgebra.h"
+#include "Exceptions.h"
+#include "Parallel.h"
+#include <algorithm>
+
+namespace
+{
+	///Reads the merged intervals of a sorted interval array one by one.
+	class MergedReader
+	{
+	public:
+		MergedReader(const Interval* intervals, int count)
+			: intervals_(intervals)
+			, count_(count)
+			, next_(0)
+			, valid_(false)
+			, start_(0)
+			, end_(0)
+		{
+			advance();
+		}
+
+		///Returns if there is a current interval.
+		bool valid() const
+		{
+			return valid_;
+		}
+		///Start of the current interval.
+		qint64 start() const
+		{
+			return start_;
+		}
+		///End of the current interval.
+		qint64 end() const
+		{
+			return end_;
+		}
+
+		///Moves to the next merged interval.
+		void advance()
+		{
+			valid_ = next_<count_;
+			if (!valid_) return;
+
+			checkOrder();
+			start_ = intervals_[next_].start();
+			end_ = intervals_[next_].end();
+			++next_;
+			while (next_<count_ && intervals_[next_].start()<=end_+1)
+			{
+				checkOrder();
+				end_ = std::max(end_, (qint64)intervals_[next_].end());
+				++next_;
+			}
+		}
+
+	protected:
+		void checkOrder() const
+		{
+			if (next_>0 && intervals_[next_].start()<intervals_[next_-1].start())
+			{
+				THROW(ArgumentException, "Interval set operations require intervals sorted by start position!");
+			}
+		}
+
+		const Interval* intervals_;
+		int count_;
+		int next_;
+		bool valid_;
+		qint64 start_;
+		qint64 end_;
+	};
+
+	///Appends an interval to the output, merging it with the last output interval if they touch.
+	inline void appendMerged(Interval* output, int& count, qint64 start, qint64 end)
+	{
+		if (count>0 && (qint64)output[count-1].end()+1>=start)
+		{
+			output[count-1] = Interval(output[count-1].start(), std::max((qint64)output[count-1].end(), end), -1);
+		}
+		else
+		{
+			output[count++] = Interval(start, end, -1);
+		}
+	}
+
+	///Calls a pointer-based binary operation on QVectors.
+	template <typename Operation>
+	void applyBinary(Operation op, const QVector<Interval>& a, const QVector<Interval>& b, QVector<Interval>& output)
+	{
+		//the output is also an input: write into a temporary vector, because resizing the output would change the input
+		if (&output==&a || &output==&b)
+		{
+			QVector<Interval> tmp;
+			applyBinary(op, a, b, tmp);
+			output.swap(tmp);
+			return;
+		}
+
+		output.resize(a.count() + b.count());
+		output.resize(op(a.constData(), a.count(), b.constData(), b.count(), output.data()));
+	}
+
+	///Calls a QVector-based binary operation for each sequence in parallel.
+	template <typename Operation>
+	void applyBinaryParallel(Operation op, const QVector<QVector<Interval> >& a, const QVector<QVector<Interval> >& b, QVector<QVector<Interval> >& output, int threads)
+	{
+		if (a.count()!=b.count())
+		{
+			THROW(ArgumentException, "Interval set operations require the same number of sequences for both operands!");
+		}
+		output.resize(a.count());
+		QVector<Interval>* out = output.data();
+		Parallel::forEach(a.count(), [op, &a, &b, out](int i, int /*worker*/)
+		{
+			applyBinary(op, a[i], b[i], out[i]);
+		}, threads);
+	}
+}
+
+int IntervalAlgebra::merge(const Interval* a, int n, Interval* output)
+{
+	int count = 0;
+	for (MergedReader reader(a, n); reader.valid(); reader.advance())
+	{
+		output[count++] = Interval(reader.start(), reader.end(), -1);
+	}
+	return count;
+}
+
+int IntervalAlgebra::unite(const Interval* a, int n, const Interval* b, int m, Interval* output)
+{
+	int count = 0;
+	MergedReader reader_a(a, n);
+	MergedReader reader_b(b, m);
+	while (reader_a.valid() || reader_b.valid())
+	{
+		MergedReader& reader = (!reader_b.valid() || (reader_a.valid() && reader_a.start()<=reader_b.start())) ? reader_a : reader_b;
+		appendMerged(output, count, reader.start(), reader.end());
+		reader.advance();
+	}
+	return count;
+}
+
+int IntervalAlgebra::intersect(const Interval* a, int n, const Interval* b, int m, Interval* output)
+{
+	int count = 0;
+	MergedReader reader_a(a, n);
+	MergedReader reader_b(b, m);
+	while (reader_a.valid() && reader_b.valid())
+	{
+		qint64 start = std::max(reader_a.start(), reader_b.start());
+		qint64 end = std::min(reader_a.end(), reader_b.end());
+		if (start<=end)
+		{
+			output[count++] = Interval(start, end, -1);
+		}
+
+		//the interval that ends first cannot overlap anything else
+		if (reader_a.end()<reader_b.end())
+		{
+			reader_a.advance();
+		}
+		else
+		{
+			reader_b.advance();
+		}
+	}
+	return count;
+}
+
+int IntervalAlgebra::subtract(const Interval* a, int n, const Interval* b, int m, Interval* output)
+{
+	int count = 0;
+	MergedReader reader_b(b, m);
+	for (MergedReader reader_a(a, n); reader_a.valid(); reader_a.advance())
+	{
+		qint64 pos = reader_a.start();
+		const qint64 end = reader_a.end();
+
+		//skip intervals of b that end before the current position
+		while (reader_b.valid() && reader_b.end()<pos)
+		{
+			reader_b.advance();
+		}
+
+		//cut out the intervals of b
+		while (reader_b.valid() && reader_b.start()<=end)
+		{
+			if (reader_b.start()>pos)
+			{
+				output[count++] = Interval(pos, reader_b.start()-1, -1);
+			}
+			pos = std::max(pos, reader_b.end()+1);
+
+			//keep intervals of b that reach into the next interval of a
+			if (reader_b.end()>end) break;
+			reader_b.advance();
+		}
+
+		if (pos<=end)
+		{
+			output[count++] = Interval(pos, end, -1);
+		}
+	}
+	return count;
+}
+
+int IntervalAlgebra::complement(const Interval* a, int n, int start, int end, Interval* output)
+{
+	int count = 0;
+	qint64 pos = start;
+	for (MergedReader reader(a, n); reader.valid() && reader.start()<=end; reader.advance())
+	{
+		if (reader.start()>pos)
+		{
+			output[count++] = Interval(pos, reader.start()-1, -1);
+		}
+		pos = std::max(pos, reader.end()+1);
+	}
+	if (pos<=end)
+	{
+		output[count++] = Interval(pos, end, -1);
+	}
+	return count;
+}
+
+qint64 IntervalAlgebra::baseCount(const Interval* a, int n)
+{
+	qint64 count = 0;
+	for (MergedReader reader(a, n); reader.valid(); reader.advance())
+	{
+		count += reader.end() - reader.start() + 1;
+	}
+	return count;
+}
+
+qint64 IntervalAlgebra::intersectionBaseCount(const Interval* a, int n, const Interval* b, int m)
+{
+	qint64 count = 0;
+	MergedReader reader_a(a, n);
+	MergedReader reader_b(b, m);
+	while (reader_a.valid() && reader_b.valid())
+	{
+		qint64 start = std::max(reader_a.start(), reader_b.start());
+		qint64 end = std::min(reader_a.end(), reader_b.end());
+		if (start<=end)
+		{
+			count += end - start + 1;
+		}
+
+		if (reader_a.end()<reader_b.end())
+		{
+			reader_a.advance();
+		}
+		else
+		{
+			reader_b.advance();
+		}
+	}
+	return count;
+}
+
+double IntervalAlgebra::jaccard(const Interval* a, int n, const Interval* b, int m)
+{
+	qint64 intersection = intersectionBaseCount(a, n, b, m);
+	qint64 union_size = baseCount(a, n) + baseCount(b, m) - intersection;
+	if (union_size==0) return 0.0;
+
+	return (double)intersection / union_size;
+}
+
+void IntervalAlgebra::merge(const QVector<Interval>& a, QVector<Interval>& output)
+{
+	if (&output==&a)
+	{
+		QVector<Interval> tmp;
+		merge(a, tmp);
+		output.swap(tmp);
+		return;
+	}
+
+	output.resize(a.count());
+	output.resize(merge(a.constData(), a.count(), output.data()));
+}
+
+void IntervalAlgebra::unite(const QVector<Interval>& a, const QVector<Interval>& b, QVector<Interval>& output)
+{
+	int (*op)(const Interval*, int, const Interval*, int, Interval*) = &IntervalAlgebra::unite;
+	applyBinary(op, a, b, output);
+}
+
+void IntervalAlgebra::intersect(const QVector<Interval>& a, const QVector<Interval>& b, QVector<Interval>& output)
+{
+	int (*op)(const Interval*, int, const Interval*, int, Interval*) = &IntervalAlgebra::intersect;
+	applyBinary(op, a, b, output);
+}
+
+void IntervalAlgebra::subtract(const QVector<Interval>& a, const QVector<Interval>& b, QVector<Interval>& output)
+{
+	int (*op)(const Interval*, int, const Interval*, int, Interval*) = &IntervalAlgebra::subtract;
+	applyBinary(op, a, b, output);
+}
+
+void IntervalAlgebra::complement(const QVector<Interval>& a, int start, int end, QVector<Interval>& output)
+{
+	if (&output==&a)
+	{
+		QVector<Interval> tmp;
+		complement(a, start, end, tmp);
+		output.swap(tmp);
+		return;
+	}
+
+	output.resize(a.count() + 1);
+	output.resize(complement(a.constData(), a.count(), start, end, output.data()));
+}
+
+double IntervalAlgebra::jaccard(const QVector<Interval>& a, const QVector<Interval>& b)
+{
+	return jaccard(a.constData(), a.count(), b.constData(), b.count());
+}
+
+void IntervalAlgebra::merge(const QVector<QVector<Interval> >& a, QVector<QVector<Interval> >& output, int threads)
+{
+	output.resize(a.count());
+	QVector<Interval>* out = output.data();
+	Parallel::forEach(a.count(), [&a, out](int i, int /*worker*/)
+	{
+		merge(a[i], out[i]);
+	}, threads);
+}
+
+void IntervalAlgebra::unite(const QVector<QVector<Interval> >& a, const QVector<QVector<Interval> >& b, QVector<QVector<Interval> >& output, int threads)
+{
+	int (*op)(const Interval*, int, const Interval*, int, Interval*) = &IntervalAlgebra::unite;
+	applyBinaryParallel(op, a, b, output, threads);
+}
+
+void IntervalAlgebra::intersect(const QVector<QVector<Interval> >& a, const QVector<QVector<Interval> >& b, QVector<QVector<Interval> >& output, int threads)
+{
+	int (*op)(const Interval*, int, const Interval*, int, Interval*) = &IntervalAlgebra::intersect;
+	applyBinaryParallel(op, a, b, output, threads);
+}
+
+void IntervalAlgebra::subtract(const QVector<QVector<Interval> >& a, const QVector<QVector<Interval> >& b, QVector<QVector<Interval> >& output, int threads)
+{
+	int (*op)(const Interval*, int, const Interval*, int, Interval*) = &IntervalAlgebra::subtract;
+	applyBinaryParallel(op, a, b, output, threads);
+}
+
+void IntervalAlgebra::complement(const QVector<QVector<Interval> >& a, const QVector<int>& lengths, QVector<QVector<Interval> >& output, int threads)
+{
+	if (a.count()!=lengths.count())
+	{
+		THROW(ArgumentException, "Interval complement requires one length per sequence!");
+	}
+	output.resize(a.count());
+	QVector<Interval>* out = output.data();
+	Parallel::forEach(a.count(), [&a, &lengths, out](int i, int /*worker*/)
+	{
+		complement(a[i], 1, lengths[i], out[i]);
+	}, threads);
+}
+
+double IntervalAlgebra::jaccard(const QVector<QVector<Interval> >& a, const QVector<QVector<Interval> >& b, int threads)
+{
+	if (a.count()!=b.count())
+	{
+		THROW(ArgumentException, "Interval set operations require the same number of sequences for both operands!");
+	}
+
+	//per-sequence base counts (summed in sequence order, so the result does not depend on the thread count)
+	QVector<qint64> intersection(a.count(), 0);
+	QVector<qint64> union_size(a.count(), 0);
+	qint64* inter = intersection.data();
+	qint64* uni = union_size.data();
+	Parallel::forEach(a.count(), [&a, &b, inter, uni](int i, int /*worker*/)
+	{
+		inter[i] = intersectionBaseCount(a[i].constData(), a[i].count(), b[i].constData(), b[i].count());
+		uni[i] = baseCount(a[i].constData(), a[i].count()) + baseCount(b[i].constData(), b[i].count()) - inter[i];
+	}, threads);
+
+	qint64 intersection_sum = 0;
+	qint64 union_sum = 0;
+	for (int i=0; i<a.count(); ++i)
+	{
+		intersection_sum += intersection[i];
+		union_sum += union_size[i];
+	}
+	if (union_sum==0) return 0.0;
+
+	return (double)intersection_sum / union_sum;
+}
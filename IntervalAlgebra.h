@@ -0,0 +1,71 @@
+#ifndef INTERVALALGEBRA_H
+#define INTERVALALGEBRA_H
+
+#include "cppCORE_global.h"
+#include "IntervalTree.h"
+#include <QVector>
+
+/**
+  @brief Set operations on interval arrays that are sorted by start position.
+
+  All operations are a single linear sweep over the input arrays. Intervals are closed, i.e. start and end position are part of the interval.
+  The input intervals may overlap each other; overlapping and adjacent intervals are merged on the fly. An ArgumentException is thrown if the input is not sorted.
+  The output intervals are sorted, merged and have the value -1.
+
+  The pointer-based functions write into a buffer provided by the caller that must be large enough for the documented maximum output size.
+  They return the number of intervals written (the output buffer must not overlap the input arrays). The QVector-based overloads resize the output vector,
+  so re-using the same output vector avoids re-allocations. The output vector may also be one of the inputs, e.g. merge(v, v).
+  The overloads for several sequences take one interval vector per sequence (same sequence order in all arguments) and process the sequences in parallel.
+*/
+class CPPCORESHARED_EXPORT IntervalAlgebra
+{
+public:
+	///Merges overlapping and adjacent intervals. The output size is at most @p n.
+	static int merge(const Interval* a, int n, Interval* output);
+	///Calculates the union of two interval arrays. The output size is at most @p n + @p m.
+	static int unite(const Interval* a, int n, const Interval* b, int m, Interval* output);
+	///Calculates the intersection of two interval arrays. The output size is at most @p n + @p m.
+	static int intersect(const Interval* a, int n, const Interval* b, int m, Interval* output);
+	///Subtracts the second interval array from the first interval array. The output size is at most @p n + @p m.
+	static int subtract(const Interval* a, int n, const Interval* b, int m, Interval* output);
+	///Calculates the complement of an interval array in the range [start, end], e.g. [1, sequence length]. The output size is at most @p n + 1.
+	static int complement(const Interval* a, int n, int start, int end, Interval* output);
+	///Returns the number of positions covered by the intervals.
+	static qint64 baseCount(const Interval* a, int n);
+	///Returns the number of positions covered by both interval arrays.
+	static qint64 intersectionBaseCount(const Interval* a, int n, const Interval* b, int m);
+	///Returns the Jaccard index of the covered positions, i.e. intersection size divided by union size. Returns 0 if both arrays are empty.
+	static double jaccard(const Interval* a, int n, const Interval* b, int m);
+
+	///Convenience overload of merge().
+	static void merge(const QVector<Interval>& a, QVector<Interval>& output);
+	///Convenience overload of unite().
+	static void unite(const QVector<Interval>& a, const QVector<Interval>& b, QVector<Interval>& output);
+	///Convenience overload of intersect().
+	static void intersect(const QVector<Interval>& a, const QVector<Interval>& b, QVector<Interval>& output);
+	///Convenience overload of subtract().
+	static void subtract(const QVector<Interval>& a, const QVector<Interval>& b, QVector<Interval>& output);
+	///Convenience overload of complement().
+	static void complement(const QVector<Interval>& a, int start, int end, QVector<Interval>& output);
+	///Convenience overload of jaccard().
+	static double jaccard(const QVector<Interval>& a, const QVector<Interval>& b);
+
+	///Merges the intervals of several sequences in parallel.
+	static void merge(const QVector<QVector<Interval> >& a, QVector<QVector<Interval> >& output, int threads=0);
+	///Unites the intervals of several sequences in parallel.
+	static void unite(const QVector<QVector<Interval> >& a, const QVector<QVector<Interval> >& b, QVector<QVector<Interval> >& output, int threads=0);
+	///Intersects the intervals of several sequences in parallel.
+	static void intersect(const QVector<QVector<Interval> >& a, const QVector<QVector<Interval> >& b, QVector<QVector<Interval> >& output, int threads=0);
+	///Subtracts the intervals of several sequences in parallel.
+	static void subtract(const QVector<QVector<Interval> >& a, const QVector<QVector<Interval> >& b, QVector<QVector<Interval> >& output, int threads=0);
+	///Calculates the complement of the intervals of several sequences in parallel. The range of each sequence is [1, sequence length].
+	static void complement(const QVector<QVector<Interval> >& a, const QVector<int>& lengths, QVector<QVector<Interval> >& output, int threads=0);
+	///Returns the Jaccard index of the covered positions over all sequences.
+	static double jaccard(const QVector<QVector<Interval> >& a, const QVector<QVector<Interval> >& b, int threads=0);
+
+protected:
+	///Constructor declared away.
+	IntervalAlgebra();
+};
+
+#endif // INTERVALALGEBRA_H
@@ -0,0 +1,165 @@
+#include "IntervalAnnotator.h"
+#include "TSVFileStream.h"
+#include "Helper.h"
+#include "Exceptions.h"
+#include "Parallel.h"
+
+namespace
+{
+	///Appends the columns of a record to a line, separated by tab.
+	void appendColumns(QByteArray& line, const QList<QByteArray>& columns)
+	{
+		for (int i=0; i<columns.count(); ++i)
+		{
+			if (i>0) line.append('\t');
+			line.append(columns[i]);
+		}
+	}
+}
+
+IntervalAnnotator::IntervalAnnotator(QString target_file, const QVector<int>& columns)
+{
+	TSVFileStream stream(target_file);
+	if (stream.columns()<3)
+	{
+		THROW(FileParseException, "Target file '" + target_file + "' must have at least three columns (sequence, start, end)!");
+	}
+	foreach(int column, columns)
+	{
+		if (column<0 || column>=stream.columns())
+		{
+			THROW(ArgumentException, "Annotation column " + QString::number(column) + " is out of range for target file '" + target_file + "'!");
+		}
+		column_names_.append(stream.header()[column]);
+	}
+
+	while (!stream.atEnd())
+	{
+		QList<QByteArray> parts = stream.readLine();
+		if (parts.isEmpty()) continue;
+
+		const QString line = QString::number(stream.lineIndex());
+		int start = Helper::toInt(parts[1], "start position", line);
+		int end = Helper::toInt(parts[2], "end position", line);
+		index_.add(parts[0], start, end, index_.count());
+		foreach(int column, columns)
+		{
+			values_.append(parts[column]);
+		}
+	}
+	index_.build();
+}
+
+void IntervalAnnotator::annotate(const QByteArray& sequence, int start, int end, QByteArray& output, QVector<int>& matches) const
+{
+	index_.overlappingIntervals(sequence, start, end, matches);
+
+	const int column_count = column_names_.count();
+	for (int c=0; c<column_count; ++c)
+	{
+		output.append('\t');
+
+		//distinct values in the order of the target start positions
+		bool first = true;
+		for (int i=0; i<matches.count(); ++i)
+		{
+			const QByteArray& value = values_[matches[i]*column_count + c];
+			bool duplicate = false;
+			for (int j=0; j<i; ++j)
+			{
+				if (values_[matches[j]*column_count + c]==value)
+				{
+					duplicate = true;
+					break;
+				}
+			}
+			if (duplicate) continue;
+
+			if (!first) output.append(',');
+			output.append(value);
+			first = false;
+		}
+	}
+}
+
+void IntervalAnnotator::annotateFile(QString query_file, QString output_file, int sequence_column, int start_column, int end_column, int threads, int chunk_size) const
+{
+	TSVFileStream stream(query_file);
+	const int max_column = std::max(sequence_column, std::max(start_column, end_column));
+	if (std::min(sequence_column, std::min(start_column, end_column))<0 || max_column>=stream.columns())
+	{
+		THROW(ArgumentException, "Position columns are out of range for query file '" + query_file + "'!");
+	}
+	if (chunk_size<=0)
+	{
+		THROW(ArgumentException, "Chunk size must be positive!");
+	}
+
+	QSharedPointer<QFile> output = Helper::openFileForWriting(output_file, true);
+
+	//comments and header
+	foreach(const QByteArray& comment, stream.comments())
+	{
+		output->write(comment + "\n");
+	}
+	bool has_header = false;
+	foreach(const QByteArray& name, stream.header())
+	{
+		if (!name.isEmpty()) has_header = true;
+	}
+	if (has_header)
+	{
+		QByteArray line = "#";
+		appendColumns(line, stream.header());
+		foreach(const QByteArray& name, column_names_)
+		{
+			line.append('\t');
+			line.append(name);
+		}
+		output->write(line + "\n");
+	}
+
+	//records (per-worker match buffers are re-used for all chunks)
+	const int workers = Parallel::threadCount(chunk_size, threads);
+	QVector<QVector<int> > match_buffers(workers);
+	QVector<int>* buffers = match_buffers.data();
+	QVector<QList<QByteArray> > records;
+	QVector<int> line_numbers;
+	QVector<QByteArray> lines;
+	while (!stream.atEnd())
+	{
+		//read chunk
+		records.clear();
+		line_numbers.clear();
+		while (records.count()<chunk_size && !stream.atEnd())
+		{
+			QList<QByteArray> parts = stream.readLine();
+			if (parts.isEmpty()) continue;
+			records.append(parts);
+			line_numbers.append(stream.lineIndex());
+		}
+
+		//annotate chunk in parallel
+		lines.resize(records.count());
+		QByteArray* chunk_lines = lines.data();
+		Parallel::forEach(records.count(), [this, &records, &line_numbers, chunk_lines, buffers, sequence_column, start_column, end_column](int i, int worker)
+		{
+			const QList<QByteArray>& parts = records[i];
+			const QString line_number = QString::number(line_numbers[i]);
+			int start = Helper::toInt(parts[start_column], "start position", line_number);
+			int end = Helper::toInt(parts[end_column], "end position", line_number);
+
+			QByteArray& line = chunk_lines[i];
+			line.clear();
+			appendColumns(line, parts);
+			annotate(parts[sequence_column], start, end, line, buffers[worker]);
+			line.append('\n');
+		}, workers);
+
+		//write chunk in input order
+		foreach(const QByteArray& line, lines)
+		{
+			output->write(line);
+		}
+	}
+}
@@ -0,0 +1,55 @@
+#ifndef INTERVALANNOTATOR_H
+#define INTERVALANNOTATOR_H
+
+#include "cppCORE_global.h"
+#include "IntervalIndex.h"
+#include <QVector>
+#include <QList>
+#include <QByteArray>
+
+/**
+  @brief Annotates the records of a TSV file with columns of overlapping target intervals.
+
+  The targets are loaded from a BED-like TSV file (sequence, start and end in the first three columns) into a read-only IntervalIndex.
+  Query files are streamed in chunks: each chunk is annotated in parallel (with per-thread scratch buffers) and written in input order,
+  so the output is identical for any number of threads and the memory usage does not depend on the query file size.
+  For each annotation column, the distinct values of all overlapping targets are appended, separated by comma. Records without overlapping targets get empty columns.
+  Intervals are closed, i.e. start and end position are part of the interval. Queries and targets must use the same coordinate system.
+*/
+class CPPCORESHARED_EXPORT IntervalAnnotator
+{
+public:
+	///Constructor. Loads the targets from a TSV file. @p columns are the 0-based indices of the target columns that are appended to the query records.
+	IntervalAnnotator(QString target_file, const QVector<int>& columns);
+
+	///Returns the number of target intervals.
+	int targetCount() const
+	{
+		return index_.count();
+	}
+	///Returns the names of the annotation columns (from the target file header).
+	const QList<QByteArray>& columnNames() const
+	{
+		return column_names_;
+	}
+
+	///Appends the annotation columns (each preceded by a tab) of the region [start, end] to @p output. @p matches is a scratch buffer that can be re-used between calls.
+	void annotate(const QByteArray& sequence, int start, int end, QByteArray& output, QVector<int>& matches) const;
+	///Annotates all records of a TSV file and writes them to @p output_file (stdin/stdout if the file names are empty).
+	///Comments and header are copied, the header is extended by the annotation column names. Records are processed in chunks of @p chunk_size records using @p threads threads (non-positive value means all cores).
+	void annotateFile(QString query_file, QString output_file, int sequence_column=0, int start_column=1, int end_column=2, int threads=0, int chunk_size=100000) const;
+
+protected:
+	///Index of the targets (payload is the target number)
+	IntervalIndex index_;
+	///Annotation values (column values of target i are at i*column_names_.count())
+	QVector<QByteArray> values_;
+	///Annotation column names
+	QList<QByteArray> column_names_;
+
+	//declared away methods
+	IntervalAnnotator(const IntervalAnnotator&);
+	IntervalAnnotator& operator=(const IntervalAnnotator&);
+};
+
+#endif // INTERVALANNOTATOR_H
@@ -0,0 +1,202 @@
+#ifndef INTERVALBININDEX_H
+#define INTERVALBININDEX_H
+
+#include "cppCORE_global.h"
+#include <QVector>
+#include <list>
+#include <algorithm>
+
+/**
+  @brief Hierarchical binning index (UCSC-style) over an interval container, with the same query API as IntervalTree.
+
+  Each interval is assigned to the smallest bin of a fixed bin hierarchy that contains it completely. Bins have sizes of 128kb, 1Mb, 8Mb, 64Mb, 512Mb
+  and one bin covers everything else (e.g. negative positions). A query scans the few bins of each level that touch the query range, so short queries
+  against very large interval sets need no tree traversal. Long intervals end up in large bins that are scanned by every query touching them.
+  For 1M intervals on 250Mb, building was about 2.5x faster and queries were 2-3x faster than with IntervalTree (also with 10% intervals of 0.1-2Mb).
+  The timings can be reproduced with tools/IntervalBinIndexBenchmark.
+  Intervals within a bin are stored contiguously and sorted by start position, together with their coordinates, i.e. the container is not accessed by queries.
+  The order of the matches is not defined. Intervals are closed, i.e. start and end position are part of the interval.
+*/
+template <class T>
+class IntervalBinIndex
+{
+public:
+	///Default constructor for an empty index.
+	IntervalBinIndex();
+	///Constructor that indexes the intervals with the given indices of the container.
+	IntervalBinIndex(const T& container, const std::list<int>& indices);
+
+	///Returns true if the index is empty.
+	bool isEmpty() const
+	{
+		return entries_.isEmpty();
+	}
+	///Returns the number of intervals.
+	int count() const
+	{
+		return entries_.count();
+	}
+
+	///Determines the indices of the intervals overlapping [start, stop]. If stop_at_first_match is true, only the first overlapping interval is returned.
+	void overlappingIntervals(int start, int stop, QVector<int>& matches, bool stop_at_first_match=false) const;
+	///Calls @p visitor with the index of each interval overlapping [start, stop], without collecting the matches.
+	///The visitor returns false to stop the query. Returns false if the query was stopped by the visitor.
+	template <typename Visitor>
+	bool visitOverlappingIntervals(int start, int stop, Visitor visitor) const;
+
+protected:
+	///Interval with the index in the container.
+	struct Entry
+	{
+		int start;
+		int end;
+		int index;
+	};
+
+	///Number of bin levels below the root bin, and the bit shift of the finest level.
+	enum
+	{
+		LEVELS = 5,
+		FIRST_SHIFT = 17,
+		NEXT_SHIFT = 3,
+		BIN_COUNT = 37449
+	};
+
+	///Returns the offset of the first bin of a level (level 0 is the root bin, level LEVELS the finest level).
+	static int levelOffset(int level)
+	{
+		static const int offsets[LEVELS+1] = {0, 1, 9, 73, 585, 4681};
+		return offsets[level];
+	}
+	///Returns the bit shift of a level.
+	static int levelShift(int level)
+	{
+		return FIRST_SHIFT + (LEVELS - level) * NEXT_SHIFT;
+	}
+	///Returns the smallest bin containing [start, end].
+	static int bin(int start, int end);
+	///Scans the entries of bin range [first_bin, last_bin]. Returns false if the visitor stopped the query.
+	template <typename Visitor>
+	bool visitBins(int first_bin, int last_bin, int start, int stop, Visitor& visitor) const;
+
+	///Offset of the first entry of each bin in entries_ (one more than the number of bins)
+	QVector<int> bin_offsets_;
+	///Entries grouped by bin and sorted by start position
+	QVector<Entry> entries_;
+};
+
+template <class T>
+IntervalBinIndex<T>::IntervalBinIndex()
+{
+}
+
+template <class T>
+IntervalBinIndex<T>::IntervalBinIndex(const T& container, const std::list<int>& indices)
+	: bin_offsets_(BIN_COUNT+1, 0)
+{
+	//count entries per bin
+	QVector<int> bins;
+	bins.reserve(indices.size());
+	for (std::list<int>::const_iterator it=indices.begin(); it!=indices.end(); ++it)
+	{
+		bins.append(bin(container[*it].start(), container[*it].end()));
+		++bin_offsets_[bins.last()+1];
+	}
+	for (int b=0; b<BIN_COUNT; ++b)
+	{
+		bin_offsets_[b+1] += bin_offsets_[b];
+	}
+
+	//group entries by bin
+	entries_.resize(bins.count());
+	QVector<int> next = bin_offsets_;
+	int i = 0;
+	for (std::list<int>::const_iterator it=indices.begin(); it!=indices.end(); ++it, ++i)
+	{
+		Entry& entry = entries_[next[bins[i]]++];
+		entry.start = container[*it].start();
+		entry.end = container[*it].end();
+		entry.index = *it;
+	}
+
+	//sort entries of each bin by start position
+	for (int b=0; b<BIN_COUNT; ++b)
+	{
+		if (bin_offsets_[b+1]-bin_offsets_[b]>1)
+		{
+			std::sort(entries_.begin()+bin_offsets_[b], entries_.begin()+bin_offsets_[b+1], [](const Entry& a, const Entry& b)
+			{
+				return a.start < b.start;
+			});
+		}
+	}
+}
+
+template <class T>
+int IntervalBinIndex<T>::bin(int start, int end)
+{
+	if (start<0) return 0;
+
+	for (int level=LEVELS; level>0; --level)
+	{
+		const int shift = levelShift(level);
+		if ((start>>shift)==(end>>shift))
+		{
+			return levelOffset(level) + (start>>shift);
+		}
+	}
+	return 0;
+}
+
+template <class T>
+template <typename Visitor>
+bool IntervalBinIndex<T>::visitBins(int first_bin, int last_bin, int start, int stop, Visitor& visitor) const
+{
+	const Entry* entries = entries_.constData();
+	for (int b=first_bin; b<=last_bin; ++b)
+	{
+		for (int i=bin_offsets_[b]; i<bin_offsets_[b+1] && entries[i].start<=stop; ++i)
+		{
+			if (entries[i].end>=start && !visitor(entries[i].index))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+template <class T>
+template <typename Visitor>
+bool IntervalBinIndex<T>::visitOverlappingIntervals(int start, int stop, Visitor visitor) const
+{
+	if (entries_.isEmpty() || start>stop) return true;
+
+	//root bin
+	if (!visitBins(0, 0, start, stop, visitor)) return false;
+	if (stop<0) return true;
+
+	//bins of each level that touch the query range
+	const int first = std::max(start, 0);
+	for (int level=1; level<=LEVELS; ++level)
+	{
+		const int shift = levelShift(level);
+		const int offset = levelOffset(level);
+		if (!visitBins(offset + (first>>shift), offset + (stop>>shift), start, stop, visitor)) return false;
+	}
+
+	return true;
+}
+
+template <class T>
+void IntervalBinIndex<T>::overlappingIntervals(int start, int stop, QVector<int>& matches, bool stop_at_first_match) const
+{
+	matches.clear();
+	visitOverlappingIntervals(start, stop, [&matches, stop_at_first_match](int index)
+	{
+		matches.append(index);
+		return !stop_at_first_match;
+	});
+}
+
+#endif // INTERVALBININDEX_H
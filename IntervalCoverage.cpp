@@ -0,0 +1,144 @@
+#include "IntervalCoverage.h"
+#include "Exceptions.h"
+#include "Parallel.h"
+#include <algorithm>
+
+IntervalCoverage::IntervalCoverage(const QVector<Interval>& intervals)
+{
+	foreach(const Interval& interval, intervals)
+	{
+		index_.add(QByteArray(), interval.start(), interval.end(), -1);
+	}
+	index_.build(1);
+}
+
+void IntervalCoverage::depth(int start, int end, QVector<DepthSegment>& segments) const
+{
+	segments.clear();
+	if (start>end)
+	{
+		THROW(ArgumentException, "Cannot calculate depth of invalid region " + QString::number(start) + "-" + QString::number(end) + "!");
+	}
+
+	//difference array: depth increases at the (clipped) start positions and decreases after the (clipped) end positions (the index reports the intervals ordered by start position, so only the decreases need sorting)
+	QVector<qint64> increases;
+	QVector<qint64> decreases;
+	index_.visitOverlappingIntervals(0, start, end, [start, end, &increases, &decreases](int interval_start, int interval_end, int /*payload*/)
+	{
+		increases.append(std::max(interval_start, start));
+		decreases.append((qint64)std::min(interval_end, end) + 1);
+		return true;
+	});
+	std::sort(decreases.begin(), decreases.end());
+
+	//accumulate
+	int depth = 0;
+	int i_inc = 0;
+	int i_dec = 0;
+	qint64 pos = start;
+	while (pos<=end)
+	{
+		while (i_inc<increases.count() && increases[i_inc]==pos)
+		{
+			++depth;
+			++i_inc;
+		}
+		while (i_dec<decreases.count() && decreases[i_dec]==pos)
+		{
+			--depth;
+			++i_dec;
+		}
+
+		qint64 next = (qint64)end + 1;
+		if (i_inc<increases.count()) next = std::min(next, increases[i_inc]);
+		if (i_dec<decreases.count()) next = std::min(next, decreases[i_dec]);
+
+		if (!segments.isEmpty() && segments.last().depth==depth)
+		{
+			segments.last().end = next - 1;
+		}
+		else
+		{
+			DepthSegment segment;
+			segment.start = pos;
+			segment.end = next - 1;
+			segment.depth = depth;
+			segments.append(segment);
+		}
+		pos = next;
+	}
+}
+
+void IntervalCoverage::binSums(int start, int end, int bin_size, QVector<double>& sums) const
+{
+	if (bin_size<=0)
+	{
+		THROW(ArgumentException, "Cannot calculate depth of bins with non-positive size!");
+	}
+
+	QVector<DepthSegment> segments;
+	depth(start, end, segments);
+
+	const qint64 length = (qint64)end - start + 1;
+	sums.fill(0.0, (length + bin_size - 1) / bin_size);
+	foreach(const DepthSegment& segment, segments)
+	{
+		if (segment.depth==0) continue;
+
+		//distribute the segment over the bins it spans
+		qint64 pos = segment.start;
+		while (pos<=segment.end)
+		{
+			const qint64 bin = (pos - start) / bin_size;
+			const qint64 segment_end = std::min((qint64)segment.end, start + (bin+1) * bin_size - 1);
+			sums[bin] += (double)segment.depth * (segment_end - pos + 1);
+			pos = segment_end + 1;
+		}
+	}
+}
+
+void IntervalCoverage::depth(const QVector<Interval>& regions, QVector<QVector<DepthSegment> >& segments, int threads) const
+{
+	segments.resize(regions.count());
+	QVector<DepthSegment>* output = segments.data();
+	Parallel::forEach(regions.count(), [this, &regions, output](int i, int /*worker*/)
+	{
+		depth(regions[i].start(), regions[i].end(), output[i]);
+	}, threads);
+}
+
+void IntervalCoverage::depthHistogram(const QVector<Interval>& regions, Histogram& histogram, bool ignore_bounds_errors, int threads) const
+{
+	//count positions per depth (one count array and segment buffer per worker thread)
+	const int workers = Parallel::threadCount(regions.count(), threads);
+	QVector<QVector<DepthSegment> > segment_buffers(workers);
+	QVector<QVector<double> > depth_counts(workers);
+	QVector<DepthSegment>* buffers = segment_buffers.data();
+	QVector<double>* counts = depth_counts.data();
+	Parallel::forEach(regions.count(), [this, &regions, buffers, counts](int i, int worker)
+	{
+		QVector<DepthSegment>& segments = buffers[worker];
+		QVector<double>& worker_counts = counts[worker];
+		depth(regions[i].start(), regions[i].end(), segments);
+		foreach(const DepthSegment& segment, segments)
+		{
+			if (segment.depth>=worker_counts.count())
+			{
+				worker_counts.resize(segment.depth + 1);
+			}
+			worker_counts[segment.depth] += (double)segment.end - segment.start + 1;
+		}
+	}, workers);
+
+	//add to histogram
+	for (int w=0; w<workers; ++w)
+	{
+		for (int depth=0; depth<depth_counts[w].count(); ++depth)
+		{
+			if (depth_counts[w][depth]>0.0)
+			{
+				histogram.incBy(depth, depth_counts[w][depth], ignore_bounds_errors);
+			}
+		}
+	}
+}
@@ -0,0 +1,46 @@
+#ifndef INTERVALCOVERAGE_H
+#define INTERVALCOVERAGE_H
+
+#include "cppCORE_global.h"
+#include "IntervalTree.h"
+#include "IntervalIndex.h"
+#include "Histogram.h"
+#include <QVector>
+
+///Run of positions with the same coverage depth.
+struct CPPCORESHARED_EXPORT DepthSegment
+{
+	int start;
+	int end;
+	int depth;
+};
+
+/**
+  @brief Coverage depth calculation for the intervals of one sequence.
+
+  The intervals are stored in an IntervalIndex. The depth of a region is calculated by accumulating a (sparse) difference array of the start
+  and end positions of the intervals overlapping the region, i.e. the run-time is O(log(n) + k*log(k)) where k is the number of these intervals.
+  Intervals and regions are closed, i.e. start and end position are part of the interval.
+*/
+class CPPCORESHARED_EXPORT IntervalCoverage
+{
+public:
+	///Constructor. The intervals do not need to be sorted.
+	IntervalCoverage(const QVector<Interval>& intervals);
+
+	///Calculates the depth of the region [start, end] as run-length encoded segments. Segments with depth 0 are included, i.e. the segments cover the whole region.
+	void depth(int start, int end, QVector<DepthSegment>& segments) const;
+	///Calculates the depth sums of bins with width @p bin_size in the region [start, end], i.e. the number of covered positions per bin. The last bin may be shorter. Divide by the bin width to get the mean depth.
+	void binSums(int start, int end, int bin_size, QVector<double>& sums) const;
+
+	///Calculates the depth segments of several regions in parallel.
+	void depth(const QVector<Interval>& regions, QVector<QVector<DepthSegment> >& segments, int threads=0) const;
+	///Adds the depth of each position in the regions to a histogram (depth distribution). The regions are processed in parallel.
+	void depthHistogram(const QVector<Interval>& regions, Histogram& histogram, bool ignore_bounds_errors=true, int threads=0) const;
+
+protected:
+	///Index of the intervals (one sequence, the payload is not used)
+	IntervalIndex index_;
+};
+
+#endif // INTERVALCOVERAGE_H
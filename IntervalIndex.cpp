@@ -0,0 +1,338 @@
+#include "IntervalIndex.h"
+#include <QElapsedTimer>
+#include <QThread>
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	///File format magic bytes and version. Increase the version when the layout changes.
+	const char INDEX_FILE_MAGIC[8] = {'C', 'P', 'P', 'I', 'I', 'D', 'X', '\0'};
+	const quint32 INDEX_FILE_VERSION = 2;
+	const quint32 INDEX_FILE_BYTE_ORDER = 0x01020304;
+
+	///File header. The sequence table, the sequence names and the entries follow.
+	struct IndexFileHeader
+	{
+		char magic[8];
+		quint32 version;
+		quint32 byte_order;
+		quint32 entry_size;
+		quint32 coordinate_size;
+		quint32 payload_size;
+		quint32 sequence_count;
+		qint64 entry_count;
+		qint64 names_size;
+		qint64 entries_offset;
+	};
+
+	///Returns the root level of the implicit tree of @p count entries, see BasicIntervalIndex::buildTree().
+	int rootLevel(int count)
+	{
+		int level = -1;
+		while (count>0)
+		{
+			count >>= 1;
+			++level;
+		}
+		return level;
+	}
+}
+
+IntervalIndexBase::IntervalIndexBase()
+	: count_(0)
+	, built_(true)
+{
+}
+
+int IntervalIndexBase::addSequence(const QByteArray& sequence)
+{
+	int id = ids_.value(sequence, -1);
+	if (id==-1)
+	{
+		id = names_.count();
+		names_.append(sequence);
+		ids_.insert(sequence, id);
+	}
+	return id;
+}
+
+void IntervalIndexBase::restoreEntrySequences()
+{
+	if (entry_sequences_.count()==count_) return;
+
+	entry_sequences_.resize(count_);
+	for (int i=0; i<sequences_.count(); ++i)
+	{
+		std::fill(entry_sequences_.begin() + sequences_[i].offset, entry_sequences_.begin() + sequences_[i].offset + sequences_[i].count, i);
+	}
+}
+
+QVector<int> IntervalIndexBase::groupBySequence()
+{
+	//count entries per sequence
+	sequences_.fill(Sequence(), names_.count());
+	for (int i=0; i<sequences_.count(); ++i)
+	{
+		sequences_[i].offset = 0;
+		sequences_[i].count = 0;
+		sequences_[i].root_level = -1;
+	}
+	foreach(int id, entry_sequences_)
+	{
+		++sequences_[id].count;
+	}
+	int offset = 0;
+	for (int i=0; i<sequences_.count(); ++i)
+	{
+		sequences_[i].offset = offset;
+		offset += sequences_[i].count;
+	}
+
+	//target index of each entry
+	QVector<int> next(sequences_.count());
+	for (int i=0; i<sequences_.count(); ++i)
+	{
+		next[i] = sequences_[i].offset;
+	}
+	QVector<int> targets(entry_sequences_.count());
+	for (int i=0; i<entry_sequences_.count(); ++i)
+	{
+		targets[i] = next[entry_sequences_[i]]++;
+	}
+	entry_sequences_.clear();
+	entry_sequences_.squeeze();
+
+	return targets;
+}
+
+void IntervalIndexBase::checkBuilt() const
+{
+	if (!built_)
+	{
+		THROW(ProgrammingException, "IntervalIndex cannot be queried before it is built!");
+	}
+}
+
+QByteArray IntervalIndexBase::headerImage(int entry_size, int coordinate_size, int payload_size, qint64& entries_offset) const
+{
+	//names
+	QByteArray names;
+	foreach(const QByteArray& name, names_)
+	{
+		qint32 length = name.length();
+		names.append(reinterpret_cast<const char*>(&length), sizeof(length));
+		names.append(name);
+	}
+
+	//header
+	IndexFileHeader header;
+	std::copy(INDEX_FILE_MAGIC, INDEX_FILE_MAGIC + 8, header.magic);
+	header.version = INDEX_FILE_VERSION;
+	header.byte_order = INDEX_FILE_BYTE_ORDER;
+	header.entry_size = entry_size;
+	header.coordinate_size = coordinate_size;
+	header.payload_size = payload_size;
+	header.sequence_count = sequences_.count();
+	header.entry_count = count_;
+	header.names_size = names.size();
+	qint64 size = sizeof(IndexFileHeader) + sequences_.count() * sizeof(Sequence) + names.size();
+	header.entries_offset = (size + 63) / 64 * 64;
+	entries_offset = header.entries_offset;
+
+	//image (padded to the entries offset)
+	QByteArray image;
+	image.reserve(entries_offset);
+	image.append(reinterpret_cast<const char*>(&header), sizeof(header));
+	image.append(reinterpret_cast<const char*>(sequences_.constData()), sequences_.count() * sizeof(Sequence));
+	image.append(names);
+	image.append(QByteArray(entries_offset - image.size(), '\0'));
+
+	return image;
+}
+
+void IntervalIndexBase::storeImage(QString filename, const char* entries, int entry_size, int coordinate_size, int payload_size) const
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		THROW(FileAccessException, "Could not open file for writing: '" + filename + "'!");
+	}
+
+	qint64 entries_offset = 0;
+	QByteArray header = headerImage(entry_size, coordinate_size, payload_size, entries_offset);
+	const qint64 entries_size = count_ * (qint64)entry_size;
+	if (file.write(header)!=header.size() || file.write(entries, entries_size)!=entries_size)
+	{
+		THROW(FileAccessException, "Could not write interval index '" + filename + "': " + file.errorString());
+	}
+}
+
+qint64 IntervalIndexBase::loadHeaderImage(const uchar* data, qint64 size, int entry_size, int coordinate_size, int payload_size, QString source)
+{
+	//check header
+	IndexFileHeader header;
+	if (size<(qint64)sizeof(header))
+	{
+		THROW(FileParseException, "Interval index '" + source + "' is truncated!");
+	}
+	std::copy(data, data + sizeof(header), reinterpret_cast<uchar*>(&header));
+	if (!std::equal(INDEX_FILE_MAGIC, INDEX_FILE_MAGIC + 8, header.magic))
+	{
+		THROW(FileParseException, "'" + source + "' is not an interval index!");
+	}
+	if (header.version!=INDEX_FILE_VERSION)
+	{
+		THROW(FileParseException, "Interval index '" + source + "' has version " + QString::number(header.version) + ", but version " + QString::number(INDEX_FILE_VERSION) + " is required. Please re-create it!");
+	}
+	if (header.coordinate_size!=(quint32)coordinate_size || header.payload_size!=(quint32)payload_size)
+	{
+		THROW(FileParseException, "Interval index '" + source + "' has " + QString::number(header.coordinate_size) + "-byte coordinates and " + QString::number(header.payload_size) + "-byte payloads, but " + QString::number(coordinate_size) + "-byte coordinates and " + QString::number(payload_size) + "-byte payloads are required!");
+	}
+	if (header.byte_order!=INDEX_FILE_BYTE_ORDER || header.entry_size!=(quint32)entry_size)
+	{
+		THROW(FileParseException, "Interval index '" + source + "' was created on an incompatible platform!");
+	}
+	if (header.entry_count<0 || header.entry_count>std::numeric_limits<int>::max() || header.sequence_count>(quint32)std::numeric_limits<int>::max())
+	{
+		THROW(FileParseException, "Interval index '" + source + "' has an invalid entry or sequence count!");
+	}
+
+	//check the sizes (each part is compared to the image size before it is added, so the sums cannot overflow)
+	const qint64 table_size = header.sequence_count * (qint64)sizeof(Sequence);
+	if (table_size>size || header.names_size<0 || header.names_size>size || header.entries_offset<0 || header.entries_offset>size)
+	{
+		THROW(FileParseException, "Interval index '" + source + "' is truncated!");
+	}
+	const qint64 table_end = sizeof(header) + table_size + header.names_size;
+	if (header.entries_offset<table_end || header.entry_count * entry_size > size - header.entries_offset)
+	{
+		THROW(FileParseException, "Interval index '" + source + "' is truncated!");
+	}
+
+	//sequences (queries use offset, count and root level without further checks)
+	QVector<Sequence> sequences(header.sequence_count);
+	const uchar* pos = data + sizeof(header);
+	std::copy(pos, pos + table_size, reinterpret_cast<uchar*>(sequences.data()));
+	pos += table_size;
+	foreach(const Sequence& sequence, sequences)
+	{
+		if (sequence.offset<0 || sequence.count<0 || sequence.offset>header.entry_count-sequence.count || sequence.root_level!=rootLevel(sequence.count))
+		{
+			THROW(FileParseException, "Interval index '" + source + "' has an invalid sequence table!");
+		}
+	}
+
+	//names
+	QVector<QByteArray> names;
+	QHash<QByteArray, int> ids;
+	for (int i=0; i<sequences.count(); ++i)
+	{
+		qint32 length = 0;
+		if (pos + sizeof(length) > data + table_end)
+		{
+			THROW(FileParseException, "Interval index '" + source + "' has an invalid sequence table!");
+		}
+		std::copy(pos, pos + sizeof(length), reinterpret_cast<uchar*>(&length));
+		pos += sizeof(length);
+		if (length<0 || pos + length > data + table_end)
+		{
+			THROW(FileParseException, "Interval index '" + source + "' has an invalid sequence table!");
+		}
+		names.append(QByteArray(reinterpret_cast<const char*>(pos), length));
+		ids.insert(names.last(), i);
+		pos += length;
+	}
+
+	//replace contents
+	names_ = names;
+	ids_ = ids;
+	sequences_ = sequences;
+	entry_sequences_.clear();
+	count_ = (int)header.entry_count;
+	mapped_file_.clear();
+	attached_memory_.clear();
+	built_ = true;
+
+	return header.entries_offset;
+}
+
+const uchar* IntervalIndexBase::mapFile(QString filename, QSharedPointer<QFile>& file, qint64& size)
+{
+	file = QSharedPointer<QFile>(new QFile(filename));
+	if (!file->open(QIODevice::ReadOnly))
+	{
+		THROW(FileAccessException, "Could not open file for reading: '" + filename + "'!");
+	}
+
+	size = file->size();
+	const uchar* data = size>0 ? file->map(0, size) : 0;
+	if (data==0)
+	{
+		THROW(FileAccessException, "Could not memory-map interval index '" + filename + "': " + file->errorString());
+	}
+
+	return data;
+}
+
+void IntervalIndexBase::publishImage(QString key, const char* entries, int entry_size, int coordinate_size, int payload_size)
+{
+	//release a segment published before (it could use the same key)
+	published_memory_.clear();
+
+	qint64 entries_offset = 0;
+	QByteArray header = headerImage(entry_size, coordinate_size, payload_size, entries_offset);
+	const qint64 size = entries_offset + count_ * (qint64)entry_size;
+	if (size>std::numeric_limits<int>::max())
+	{
+		THROW(ArgumentException, "Interval index is too large for a shared memory segment (" + QString::number(size) + " bytes). Store it to a file on a memory file system instead!");
+	}
+
+	QSharedPointer<QSharedMemory> memory(new QSharedMemory(key));
+	if (!memory->create(size))
+	{
+		THROW(Exception, "Could not create shared memory segment '" + key + "' for interval index: " + memory->errorString());
+	}
+
+	//the segment is visible (zero-filled) as soon as it is created, so the magic bytes are written last: attaching processes wait until they are set
+	memory->lock();
+	char* data = static_cast<char*>(memory->data());
+	std::fill(data, data + sizeof(INDEX_FILE_MAGIC), 0);
+	std::copy(header.constData() + sizeof(INDEX_FILE_MAGIC), header.constData() + header.size(), data + sizeof(INDEX_FILE_MAGIC));
+	std::copy(entries, entries + count_ * (qint64)entry_size, data + entries_offset);
+	std::copy(INDEX_FILE_MAGIC, INDEX_FILE_MAGIC + sizeof(INDEX_FILE_MAGIC), data);
+	memory->unlock();
+
+	published_memory_ = memory;
+}
+
+const uchar* IntervalIndexBase::attachSegment(QString key, QSharedPointer<QSharedMemory>& memory, qint64& size)
+{
+	memory = QSharedPointer<QSharedMemory>(new QSharedMemory(key));
+	if (!memory->attach(QSharedMemory::ReadOnly))
+	{
+		THROW(Exception, "Could not attach to shared memory segment '" + key + "' of interval index: " + memory->errorString());
+	}
+
+	size = memory->size();
+	const uchar* data = static_cast<const uchar*>(memory->constData());
+
+	//wait until the publisher has written the magic bytes (they are written last, while holding the lock)
+	QElapsedTimer timer;
+	timer.start();
+	while (true)
+	{
+		memory->lock();
+		const bool complete = size<(qint64)sizeof(INDEX_FILE_MAGIC) || std::any_of(data, data + sizeof(INDEX_FILE_MAGIC), [](uchar c) { return c!=0; });
+		memory->unlock();
+		if (complete) break;
+
+		if (timer.elapsed()>PUBLISH_TIMEOUT_MS)
+		{
+			THROW(Exception, "Timeout while waiting for interval index in shared memory segment '" + key + "' to be published!");
+		}
+		QThread::msleep(1);
+	}
+
+	return data;
+}
@@ -0,0 +1,464 @@
+#ifndef INTERVALINDEX_H
+#define INTERVALINDEX_H
+
+#include "cppCORE_global.h"
+#include "Exceptions.h"
+#include "Parallel.h"
+#include <QVector>
+#include <QHash>
+#include <QByteArray>
+#include <QFile>
+#include <QSharedPointer>
+#include <QSharedMemory>
+#include <algorithm>
+#include <type_traits>
+
+///Non-template part of BasicIntervalIndex: sequence bookkeeping and the binary file format.
+class CPPCORESHARED_EXPORT IntervalIndexBase
+{
+public:
+	///Returns if the index is built, i.e. if it can be queried.
+	bool isBuilt() const
+	{
+		return built_;
+	}
+
+	///Returns the number of intervals.
+	int count() const
+	{
+		return count_;
+	}
+	///Returns the number of sequences.
+	int sequenceCount() const
+	{
+		return names_.count();
+	}
+	///Returns the name of the sequence with the given id.
+	const QByteArray& sequenceName(int sequence_id) const
+	{
+		return names_[sequence_id];
+	}
+	///Returns the id of a sequence, or -1 if no interval was added for the sequence.
+	int sequenceId(const QByteArray& sequence) const
+	{
+		return ids_.value(sequence, -1);
+	}
+
+	///Returns if the intervals are memory-mapped from a file.
+	bool isMapped() const
+	{
+		return !mapped_file_.isNull();
+	}
+	///Returns if the intervals are attached from a shared memory segment.
+	bool isAttached() const
+	{
+		return !attached_memory_.isNull();
+	}
+
+protected:
+	///Range of a sequence in the entry array.
+	struct Sequence
+	{
+		int offset;
+		int count;
+		int root_level;
+	};
+
+	///Default constructor.
+	IntervalIndexBase();
+
+	///Returns the id of a sequence. Unknown sequences are added.
+	int addSequence(const QByteArray& sequence);
+	///Restores the sequence id of each entry from the sequence ranges (needed when adding to a built index).
+	void restoreEntrySequences();
+	///Calculates the sequence ranges from the sequence ids of the entries and returns the target index of each entry, i.e. the entries grouped by sequence (stable counting sort).
+	QVector<int> groupBySequence();
+	///Throws an exception if the index is not built yet.
+	void checkBuilt() const;
+
+	///Returns the binary image of everything but the entries (header, sequence table and names). The entries are stored after the header at offset @p entries_offset.
+	QByteArray headerImage(int entry_size, int coordinate_size, int payload_size, qint64& entries_offset) const;
+	///Writes the header image and the entries to a file.
+	void storeImage(QString filename, const char* entries, int entry_size, int coordinate_size, int payload_size) const;
+	///Checks the header of a binary image and replaces sequences and names by the ones of the image. Returns the offset of the entries in the image.
+	qint64 loadHeaderImage(const uchar* data, qint64 size, int entry_size, int coordinate_size, int payload_size, QString source);
+	///Opens and memory-maps a whole file. Returns the mapped data and its size.
+	static const uchar* mapFile(QString filename, QSharedPointer<QFile>& file, qint64& size);
+	///Creates a shared memory segment that contains the header image and the entries.
+	void publishImage(QString key, const char* entries, int entry_size, int coordinate_size, int payload_size);
+	///Attaches a shared memory segment read-only and waits until the publisher has written the complete image (at most PUBLISH_TIMEOUT_MS milliseconds). Returns the segment data and its size.
+	static const uchar* attachSegment(QString key, QSharedPointer<QSharedMemory>& memory, qint64& size);
+	///Maximum time attachSegment() waits for a segment that is still being written.
+	static const int PUBLISH_TIMEOUT_MS = 10000;
+
+	///Sequence names (index is the sequence id)
+	QVector<QByteArray> names_;
+	///Sequence name to sequence id
+	QHash<QByteArray, int> ids_;
+	///Sequence ranges in the entry array (index is the sequence id)
+	QVector<Sequence> sequences_;
+	///Number of intervals
+	int count_;
+	///File the intervals are mapped from
+	QSharedPointer<QFile> mapped_file_;
+	///Shared memory segment the intervals are attached from
+	QSharedPointer<QSharedMemory> attached_memory_;
+	///Shared memory segment the index was published to (kept alive by this index)
+	QSharedPointer<QSharedMemory> published_memory_;
+	///Sequence id of each entry (only used until the index is built)
+	QVector<int> entry_sequences_;
+	///Build flag
+	bool built_;
+};
+
+/**
+  @brief Interval index over several sequences (e.g. chromosomes) that owns its interval storage.
+
+  All intervals are stored in one contiguous array, grouped by sequence and sorted by start position.
+  For each sequence, the array is augmented to an implicit interval tree: the node of each sub-tree stores the maximum end position
+  of the sub-tree, so overlap queries take O(log(n) + k) time without pointers or per-node allocations (see H. Li, cgranges).
+  Intervals are closed, i.e. start and end position are part of the interval.
+
+  The index is a template on the coordinate type and the payload type. Use 64-bit coordinates for sequences longer than 2^31 bases,
+  e.g. concatenated assemblies. The payload is stored next to the coordinates and returned by the queries, so small payloads
+  like ids or scores are available without a lookup in a separate container. Payloads must be trivially copyable to store the index in a file.
+
+  Usage: add() all intervals, then call build() once. After building, the index is read-only and can be queried concurrently
+  from several threads without locking.
+
+  A built index can be stored in a binary file and memory-mapped from that file, which avoids re-building the index at every
+  program start. Processes that map the same file share the intervals in the page cache.
+  Alternatively, one process can publish() the built index to a shared memory segment, and other processes on the same host attach() to it read-only.
+  The intervals then exist only once in memory. Because QSharedMemory sizes are limited to 2GB, larger indices should be stored to a file on
+  a memory file system (e.g. /dev/shm) and loaded from there.
+*/
+template <typename Coord, typename Payload>
+class BasicIntervalIndex
+	: public IntervalIndexBase
+{
+public:
+	///Default constructor.
+	BasicIntervalIndex();
+
+	///Adds an interval. @p payload is reported by the queries, e.g. the index of the interval in a container of the caller.
+	void add(const QByteArray& sequence, Coord start, Coord end, const Payload& payload);
+	///Builds the index after intervals were added. Sequences are sorted and augmented in parallel using @p threads threads (non-positive value means all cores).
+	void build(int threads=0);
+
+	///Determines the payloads of the intervals overlapping [start, stop], ordered by start position. If stop_at_first_match is true, only the first overlapping interval is returned.
+	void overlappingIntervals(int sequence_id, Coord start, Coord stop, QVector<Payload>& matches, bool stop_at_first_match=false) const;
+	///Convenience overload that takes the sequence name.
+	void overlappingIntervals(const QByteArray& sequence, Coord start, Coord stop, QVector<Payload>& matches, bool stop_at_first_match=false) const;
+	///Returns if any interval overlaps [start, stop].
+	bool overlaps(int sequence_id, Coord start, Coord stop) const;
+	///Calls @p visitor(start, end, payload) for each interval overlapping [start, stop], ordered by start position, without collecting the matches.
+	///The visitor returns false to stop the query. Returns false if the query was stopped by the visitor.
+	template <typename Visitor>
+	bool visitOverlappingIntervals(int sequence_id, Coord start, Coord stop, Visitor visitor) const;
+
+	///Stores the built index in a binary file.
+	void store(QString filename) const;
+	///Replaces the contents of the index with the index stored in a file. The intervals are memory-mapped, i.e. the file must not be modified while the index is in use.
+	void load(QString filename);
+
+	///Publishes the built index to a shared memory segment with the given key. The segment is removed when this index and all attached indices are destroyed (or the key is re-published).
+	void publish(QString key);
+	///Replaces the contents of the index with the index published under the given key. The intervals are attached read-only, i.e. they are not copied.
+	void attach(QString key);
+
+protected:
+	///Interval with the maximum end position of the implicit sub-tree it is the root of.
+	struct Entry
+	{
+		Coord start;
+		Coord end;
+		Coord max_end;
+		Payload payload;
+	};
+
+	///Sorts entries by start position (and end position for equal starts).
+	static bool lessByPosition(const Entry& a, const Entry& b)
+	{
+		if (a.start!=b.start) return a.start < b.start;
+		return a.end < b.end;
+	}
+	///Sorts the entries of one sequence and calculates the maximum end positions. Returns the level of the root node.
+	static int buildTree(Entry* entries, int count);
+	///Returns the entry array (owned or memory-mapped).
+	const Entry* entryData() const
+	{
+		return mapped_entries_!=0 ? mapped_entries_ : entries_.constData();
+	}
+	///Copies memory-mapped entries into the owned entry array and releases the file.
+	void detachMapped();
+	///Replaces the contents of the index by a binary image. Sequences and names are copied, entries are used in place, i.e. the image must stay valid while the index is used.
+	void loadImage(const uchar* data, qint64 size, QString source);
+
+	///All intervals (grouped by sequence after building)
+	QVector<Entry> entries_;
+	///Memory-mapped intervals (used instead of entries_ if set)
+	const Entry* mapped_entries_;
+};
+
+///Interval index with 32-bit coordinates and an integer payload, e.g. the index of the interval in a container of the caller.
+typedef BasicIntervalIndex<int, int> IntervalIndex;
+
+template <typename Coord, typename Payload>
+BasicIntervalIndex<Coord, Payload>::BasicIntervalIndex()
+	: IntervalIndexBase()
+	, mapped_entries_(0)
+{
+}
+
+template <typename Coord, typename Payload>
+void BasicIntervalIndex<Coord, Payload>::add(const QByteArray& sequence, Coord start, Coord end, const Payload& payload)
+{
+	if (start>end)
+	{
+		THROW(ArgumentException, "Cannot add interval with start after end: " + sequence + ":" + QString::number(start) + "-" + QString::number(end));
+	}
+
+	//adding to a loaded index: copy entries from the file
+	detachMapped();
+
+	//adding to a built index: restore the sequence ids of the entries
+	if (built_)
+	{
+		restoreEntrySequences();
+	}
+
+	Entry entry;
+	entry.start = start;
+	entry.end = end;
+	entry.max_end = end;
+	entry.payload = payload;
+	entries_.append(entry);
+	entry_sequences_.append(addSequence(sequence));
+	++count_;
+	built_ = false;
+}
+
+template <typename Coord, typename Payload>
+void BasicIntervalIndex<Coord, Payload>::build(int threads)
+{
+	if (built_) return;
+
+	//group entries by sequence (into one new array)
+	QVector<int> targets = groupBySequence();
+	QVector<Entry> grouped(entries_.count());
+	for (int i=0; i<entries_.count(); ++i)
+	{
+		grouped[targets[i]] = entries_[i];
+	}
+	entries_.swap(grouped);
+
+	//sort and augment each sequence
+	Entry* entries = entries_.data();
+	QVector<Sequence>& sequences = sequences_;
+	Parallel::forEach(sequences_.count(), [entries, &sequences](int i, int /*worker*/)
+	{
+		sequences[i].root_level = buildTree(entries + sequences[i].offset, sequences[i].count);
+	}, threads);
+
+	built_ = true;
+}
+
+template <typename Coord, typename Payload>
+int BasicIntervalIndex<Coord, Payload>::buildTree(Entry* entries, int count)
+{
+	if (count<=0) return -1;
+
+	std::sort(entries, entries+count, lessByPosition);
+
+	//leaves (even indices)
+	int last_i = 0;
+	Coord last = Coord();
+	for (int i=0; i<count; i+=2)
+	{
+		last_i = i;
+		last = entries[i].max_end = entries[i].end;
+	}
+
+	//inner nodes, level by level. Nodes that are out of range use the maximum of the last valid sub-tree.
+	int k = 1;
+	for (; (1LL<<k)<=count; ++k)
+	{
+		const qint64 x = 1LL<<(k-1);
+		const qint64 i0 = (x<<1) - 1;
+		const qint64 step = x<<2;
+		for (qint64 i=i0; i<count; i+=step)
+		{
+			Coord max_end = entries[i].end;
+			max_end = std::max(max_end, entries[i-x].max_end);
+			max_end = std::max(max_end, i+x<count ? entries[i+x].max_end : last);
+			entries[i].max_end = max_end;
+		}
+		last_i = ((last_i>>k) & 1) ? last_i - x : last_i + x;
+		if (last_i<count && entries[last_i].max_end>last)
+		{
+			last = entries[last_i].max_end;
+		}
+	}
+
+	return k - 1;
+}
+
+template <typename Coord, typename Payload>
+template <typename Visitor>
+bool BasicIntervalIndex<Coord, Payload>::visitOverlappingIntervals(int sequence_id, Coord start, Coord stop, Visitor visitor) const
+{
+	checkBuilt();
+	if (sequence_id<0 || sequence_id>=sequences_.count()) return true;
+
+	const Sequence& sequence = sequences_[sequence_id];
+	const Entry* entries = entryData() + sequence.offset;
+	const int n = sequence.count;
+	if (n==0) return true;
+
+	//top-down traversal of the implicit tree with an explicit stack (matches are ordered by start position)
+	struct StackItem
+	{
+		qint64 node;
+		int level;
+		bool left_done;
+	};
+	StackItem stack[64];
+	int t = 0;
+	stack[t].node = (1LL<<sequence.root_level) - 1;
+	stack[t].level = sequence.root_level;
+	stack[t].left_done = false;
+	++t;
+	while (t>0)
+	{
+		const StackItem item = stack[--t];
+		if (item.level<=3)
+		{
+			//small sub-tree: linear scan of all its nodes
+			const qint64 i0 = item.node >> item.level << item.level;
+			const qint64 i1 = std::min(i0 + (1LL<<(item.level+1)) - 1, (qint64)n);
+			for (qint64 i=i0; i<i1 && entries[i].start<=stop; ++i)
+			{
+				if (entries[i].end>=start)
+				{
+					if (!visitor(entries[i].start, entries[i].end, entries[i].payload)) return false;
+				}
+			}
+		}
+		else if (!item.left_done)
+		{
+			//re-add the node with the left child marked as processed, then the left child if it may contain overlaps
+			const qint64 left = item.node - (1LL<<(item.level-1));
+			stack[t].node = item.node;
+			stack[t].level = item.level;
+			stack[t].left_done = true;
+			++t;
+			if (left>=n || entries[left].max_end>=start)
+			{
+				stack[t].node = left;
+				stack[t].level = item.level - 1;
+				stack[t].left_done = false;
+				++t;
+			}
+		}
+		else if (item.node<n && entries[item.node].start<=stop)
+		{
+			//node itself, then the right child
+			if (entries[item.node].end>=start)
+			{
+				if (!visitor(entries[item.node].start, entries[item.node].end, entries[item.node].payload)) return false;
+			}
+			stack[t].node = item.node + (1LL<<(item.level-1));
+			stack[t].level = item.level - 1;
+			stack[t].left_done = false;
+			++t;
+		}
+	}
+
+	return true;
+}
+
+template <typename Coord, typename Payload>
+void BasicIntervalIndex<Coord, Payload>::overlappingIntervals(int sequence_id, Coord start, Coord stop, QVector<Payload>& matches, bool stop_at_first_match) const
+{
+	matches.clear();
+	visitOverlappingIntervals(sequence_id, start, stop, [&matches, stop_at_first_match](Coord /*start*/, Coord /*end*/, const Payload& payload)
+	{
+		matches.append(payload);
+		return !stop_at_first_match;
+	});
+}
+
+template <typename Coord, typename Payload>
+void BasicIntervalIndex<Coord, Payload>::overlappingIntervals(const QByteArray& sequence, Coord start, Coord stop, QVector<Payload>& matches, bool stop_at_first_match) const
+{
+	overlappingIntervals(sequenceId(sequence), start, stop, matches, stop_at_first_match);
+}
+
+template <typename Coord, typename Payload>
+bool BasicIntervalIndex<Coord, Payload>::overlaps(int sequence_id, Coord start, Coord stop) const
+{
+	//the visitor stops at the first match
+	return !visitOverlappingIntervals(sequence_id, start, stop, [](Coord /*start*/, Coord /*end*/, const Payload& /*payload*/)
+	{
+		return false;
+	});
+}
+
+template <typename Coord, typename Payload>
+void BasicIntervalIndex<Coord, Payload>::detachMapped()
+{
+	if (mapped_entries_==0) return;
+
+	entries_.resize(count_);
+	std::copy(mapped_entries_, mapped_entries_ + count_, entries_.begin());
+	mapped_entries_ = 0;
+	mapped_file_.clear();
+	attached_memory_.clear();
+}
+
+template <typename Coord, typename Payload>
+void BasicIntervalIndex<Coord, Payload>::loadImage(const uchar* data, qint64 size, QString source)
+{
+	static_assert(std::is_trivially_copyable<Payload>::value, "Interval index payloads must be trivially copyable to load the index from a binary image!");
+	qint64 entries_offset = loadHeaderImage(data, size, sizeof(Entry), sizeof(Coord), sizeof(Payload), source);
+	entries_.clear();
+	mapped_entries_ = reinterpret_cast<const Entry*>(data + entries_offset);
+}
+
+template <typename Coord, typename Payload>
+void BasicIntervalIndex<Coord, Payload>::store(QString filename) const
+{
+	static_assert(std::is_trivially_copyable<Payload>::value, "Interval index payloads must be trivially copyable to store the index in a file!");
+	checkBuilt();
+	storeImage(filename, reinterpret_cast<const char*>(entryData()), sizeof(Entry), sizeof(Coord), sizeof(Payload));
+}
+
+template <typename Coord, typename Payload>
+void BasicIntervalIndex<Coord, Payload>::load(QString filename)
+{
+	QSharedPointer<QFile> file;
+	qint64 size = 0;
+	const uchar* data = mapFile(filename, file, size);
+	loadImage(data, size, filename);
+	mapped_file_ = file;
+}
+
+template <typename Coord, typename Payload>
+void BasicIntervalIndex<Coord, Payload>::publish(QString key)
+{
+	static_assert(std::is_trivially_copyable<Payload>::value, "Interval index payloads must be trivially copyable to publish the index to shared memory!");
+	checkBuilt();
+	publishImage(key, reinterpret_cast<const char*>(entryData()), sizeof(Entry), sizeof(Coord), sizeof(Payload));
+}
+
+template <typename Coord, typename Payload>
+void BasicIntervalIndex<Coord, Payload>::attach(QString key)
+{
+	QSharedPointer<QSharedMemory> memory;
+	qint64 size = 0;
+	const uchar* data = attachSegment(key, memory, size);
+	loadImage(data, size, key);
+	attached_memory_ = memory;
+}
+
+#endif // INTERVALINDEX_H
@@ -0,0 +1,103 @@
+#include "IntervalSweep.h"
+#include "Helper.h"
+#include "Exceptions.h"
+
+namespace
+{
+	///Appends the columns of a record to a line, separated by tab.
+	void appendColumns(QByteArray& line, const QList<QByteArray>& columns)
+	{
+		for (int i=0; i<columns.count(); ++i)
+		{
+			if (i>0) line.append('\t');
+			line.append(columns[i]);
+		}
+	}
+
+	///Returns if a header line is present.
+	bool hasHeader(const TSVFileStream& stream)
+	{
+		foreach(const QByteArray& name, stream.header())
+		{
+			if (!name.isEmpty()) return true;
+		}
+		return false;
+	}
+}
+
+IntervalRecordReader::IntervalRecordReader(QString filename, int sequence_column, int start_column, int end_column)
+	: filename_(filename)
+	, stream_(filename)
+	, sequence_column_(sequence_column)
+	, start_column_(start_column)
+	, end_column_(end_column)
+	, last_start_(0)
+	, first_(true)
+{
+	const int max_column = std::max(sequence_column, std::max(start_column, end_column));
+	if (std::min(sequence_column, std::min(start_column, end_column))<0 || max_column>=stream_.columns())
+	{
+		THROW(ArgumentException, "Position columns are out of range for file '" + filename + "'!");
+	}
+}
+
+bool IntervalRecordReader::next(IntervalRecord& record)
+{
+	while (!stream_.atEnd())
+	{
+		QList<QByteArray> parts = stream_.readLine();
+		if (parts.isEmpty()) continue;
+
+		const QString line = QString::number(stream_.lineIndex());
+		record.sequence = parts[sequence_column_];
+		record.start = Helper::toInt(parts[start_column_], "start position", line);
+		record.end = Helper::toInt(parts[end_column_], "end position", line);
+		record.columns = parts;
+
+		//check sort order
+		if (!first_ && (record.sequence<last_sequence_ || (record.sequence==last_sequence_ && record.start<last_start_)))
+		{
+			THROW(FileParseException, "File '" + filename_ + "' is not sorted by sequence and start position in line " + line + "!");
+		}
+		first_ = false;
+		last_sequence_ = record.sequence;
+		last_start_ = record.start;
+
+		return true;
+	}
+
+	return false;
+}
+
+void IntervalSweep::intersect(QString file_a, QString file_b, QString output_file, double min_fraction_a, double min_fraction_b)
+{
+	IntervalRecordReader a(file_a);
+	IntervalRecordReader b(file_b);
+	QSharedPointer<QFile> output = Helper::openFileForWriting(output_file, true);
+
+	//header
+	if (hasHeader(a.stream()) || hasHeader(b.stream()))
+	{
+		QByteArray line = "#";
+		appendColumns(line, a.stream().header());
+		line.append('\t');
+		appendColumns(line, b.stream().header());
+		line.append("\toverlap\n");
+		output->write(line);
+	}
+
+	//overlaps
+	QByteArray line;
+	intersect(a, b, [&output, &line](const IntervalRecord& record_a, const IntervalRecord& record_b, int overlap)
+	{
+		line.clear();
+		appendColumns(line, record_a.columns);
+		line.append('\t');
+		appendColumns(line, record_b.columns);
+		line.append('\t');
+		line.append(QByteArray::number(overlap));
+		line.append('\n');
+		output->write(line);
+		return true;
+	}, min_fraction_a, min_fraction_b);
+}
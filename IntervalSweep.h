@@ -0,0 +1,131 @@
+#ifndef INTERVALSWEEP_H
+#define INTERVALSWEEP_H
+
+#include "cppCORE_global.h"
+#include "TSVFileStream.h"
+#include <QVector>
+#include <QList>
+#include <QByteArray>
+#include <algorithm>
+
+///Interval record of a TSV file (all columns plus the parsed position).
+struct CPPCORESHARED_EXPORT IntervalRecord
+{
+	QByteArray sequence;
+	int start;
+	int end;
+	QList<QByteArray> columns;
+
+	///Returns the length of the interval (closed interval).
+	int length() const
+	{
+		return end - start + 1;
+	}
+};
+
+///Reads interval records from a TSV file that is sorted by sequence (lexicographically) and start position, e.g. with 'sort -k1,1 -k2,2n'.
+class CPPCORESHARED_EXPORT IntervalRecordReader
+{
+public:
+	///Constructor. Reads from stdin if @p filename is empty. The column indices are 0-based.
+	IntervalRecordReader(QString filename, int sequence_column=0, int start_column=1, int end_column=2);
+
+	///Reads the next record. Returns false at the end of the file. Throws a FileParseException if the records are not sorted.
+	bool next(IntervalRecord& record);
+
+	///Returns the underlying stream (header, comments, etc.).
+	const TSVFileStream& stream() const
+	{
+		return stream_;
+	}
+
+protected:
+	QString filename_;
+	TSVFileStream stream_;
+	int sequence_column_;
+	int start_column_;
+	int end_column_;
+	///Sequence and start of the last record (for the sort order check)
+	QByteArray last_sequence_;
+	int last_start_;
+	bool first_;
+
+	//declared away methods
+	IntervalRecordReader(const IntervalRecordReader&);
+	IntervalRecordReader& operator=(const IntervalRecordReader&);
+};
+
+/**
+  @brief Streaming intersection of two sorted interval files (chrom-sweep).
+
+  Both inputs are read once, in parallel. Only the records of the second input that can still overlap the current record of the first input
+  are kept in memory, i.e. the memory usage is O(maximum number of overlaps) and does not depend on the file size.
+  Both inputs must be sorted by sequence (lexicographically) and start position. Intervals are closed, i.e. start and end position are part of the interval.
+*/
+class CPPCORESHARED_EXPORT IntervalSweep
+{
+public:
+	///Calls @p visitor(record_a, record_b, overlap_length) for each overlapping pair of records, ordered by the records of @p a and then by start of the records of @p b.
+	///Pairs whose overlap is shorter than @p min_fraction_a of the length of record_a or @p min_fraction_b of the length of record_b are skipped.
+	///The visitor returns false to stop the sweep. Returns false if the sweep was stopped by the visitor.
+	template <typename Visitor>
+	static bool intersect(IntervalRecordReader& a, IntervalRecordReader& b, Visitor visitor, double min_fraction_a=0.0, double min_fraction_b=0.0);
+
+	///Intersects two sorted TSV files and writes the columns of both records followed by the overlap length (stdout if @p output_file is empty).
+	static void intersect(QString file_a, QString file_b, QString output_file, double min_fraction_a=0.0, double min_fraction_b=0.0);
+
+protected:
+	///Constructor declared away.
+	IntervalSweep();
+};
+
+template <typename Visitor>
+bool IntervalSweep::intersect(IntervalRecordReader& a, IntervalRecordReader& b, Visitor visitor, double min_fraction_a, double min_fraction_b)
+{
+	//records of b that may overlap the current or later records of a
+	QVector<IntervalRecord> window;
+	IntervalRecord next_b;
+	bool has_next_b = b.next(next_b);
+
+	IntervalRecord record_a;
+	while (a.next(record_a))
+	{
+		//remove records that are on another sequence or end before the record (a is sorted, so they cannot overlap later records)
+		int kept = 0;
+		for (int i=0; i<window.count(); ++i)
+		{
+			if (window[i].sequence==record_a.sequence && window[i].end>=record_a.start)
+			{
+				if (i!=kept) std::swap(window[kept], window[i]);
+				++kept;
+			}
+		}
+		window.resize(kept);
+
+		//add records that start before the record ends (skipping records of preceding sequences)
+		while (has_next_b && (next_b.sequence<record_a.sequence || (next_b.sequence==record_a.sequence && next_b.start<=record_a.end)))
+		{
+			if (next_b.sequence==record_a.sequence && next_b.end>=record_a.start)
+			{
+				window.append(next_b);
+			}
+			has_next_b = b.next(next_b);
+		}
+
+		//report overlaps
+		for (int i=0; i<window.count(); ++i)
+		{
+			const IntervalRecord& record_b = window[i];
+			if (record_b.start>record_a.end) continue;
+
+			int overlap = std::min(record_a.end, record_b.end) - std::max(record_a.start, record_b.start) + 1;
+			if (overlap < min_fraction_a * record_a.length() || overlap < min_fraction_b * record_b.length()) continue;
+
+			if (!visitor(record_a, record_b, overlap)) return false;
+		}
+	}
+
+	return true;
+}
+
+#endif // INTERVALSWEEP_H
@@ -3,11 +3,12 @@
 
 #include "cppCORE_global.h"
 #include <iterator>
+#include <algorithm>
 #include <QVector>
 #include <QLinkedList>
 #include <QSharedDataPointer>
 #include <QSharedData>
-#include <QScopedPointer>
+#include <QVarLengthArray>
 //#include <QTextStream>
 //#include "Helper.h"
 
@@ -19,6 +20,7 @@ public:
     Interval();
     Interval(int s, int e, int v=-1);
     Interval(const Interval &other);
+    Interval& operator=(const Interval& other) = default;
     Interval(const QVector<Interval>& intervals);
     bool isValid() const { return ((start_!=-1) && (end_!=-1)); }
 
@@ -96,27 +98,32 @@ struct CPPCORESHARED_EXPORT MaxEndPositionInterval : public std::binary_function
     }
 };
 
+template <class T>
+class IntervalTreeOverlapIterator;
+template <class T>
+class IntervalTreeCursor;
+
 /// Represents the shared data object of the IntervalTree class. This class represents the actual interval tree.
-/// Each node holds a center position, a vector of intervals, a pointer to a left and the right sub trees.
+/// Each node holds a center position, a range of interval indices and the indices of the left and the right sub trees.
+/// Nodes and interval indices are stored in two arrays owned by the tree (in pre-order, i.e. each node is followed by its left and then its
+/// right sub tree), so building, copying and destroying the tree are bulk operations without per-node allocations.
 template <class T>
 class CPPCORESHARED_EXPORT IntervalTreeData : public QSharedData
 {
 public:
     /// Default constructor for an empty tree
     IntervalTreeData();
-    /// Constructor
-    IntervalTreeData(const T& container,
-                     std::list<int>& indices,
-                     std::list<int>::iterator start_it,
-                     std::list<int>::iterator end_it,
-                     int leftextent = 0,
-                     int rightextent = 0);
+    /// Constructor that builds the tree from interval indices sorted by start position
+    IntervalTreeData(const T& container, const QVector<int>& sorted_indices);
 
     /// Copy constructor (supports implicit sharing)
     IntervalTreeData(const IntervalTreeData& other);
 
-    /// Determine recursively the overlapping intervals of [start, stop] in the interval tree
+    /// Determine the overlapping intervals of [start, stop] in the interval tree
     void findOverlappingIntervals(int start, int stop, QVector<int>& matches, bool stop_at_first_match=false) const;
+    /// Calls the visitor for the overlapping intervals of [start, stop]. Returns false if the visitor stopped the query.
+    template <typename Visitor>
+    bool visitOverlappingIntervals(int start, int stop, Visitor& visitor) const;
 
     void subtractTree(const IntervalTreeData& other, QVector<Interval>& remaining_intervals) const;
 
@@ -124,20 +131,73 @@ public:
 
 
 protected:
+    friend class IntervalTreeOverlapIterator<T>;
+
+    /// Tree node. The intervals overlapping the center position are intervals_[first, first+count), sorted by start position.
+    /// Children are node indices, -1 means 'no child'.
+    struct Node
+    {
+        int center;
+        int first;
+        int count;
+        int left;
+        int right;
+    };
+
+    /// Builds the sub tree of the interval indices work[begin, end) (sorted by start position) and returns its node index.
+    int build(QVector<int>& work, int begin, int end);
+    /// Calls the visitor recursively for the overlapping intervals in the sub tree of a node.
+    template <typename Visitor>
+    bool visitNode(int node, int start, int stop, Visitor& visitor) const;
+
     /// The interval container
-    const T& container_;
-    /// The indices of the interval tree node at the certain position
-    QVector<int> intervals_;
-    /// Pointer to the left sub interval tree
-    QScopedPointer<IntervalTreeData> left_;
-    /// Pointer to the right sub interval tree
-    QScopedPointer<IntervalTreeData> right_;
-    /// The center position at this node in the tree, i.e. all intervals which are located left of this position
+    const T* container_;
+    /// The nodes of the tree (the root is the first node)
+    QVector<Node> nodes_;
+    /// The interval indices of all nodes. All intervals which are located left of the center position of a node
     /// are stored in the left subtree and intervals which are located right to this position are stored in the right
-    /// subtree. However, the intervals overlapping with the center position are stored in intervals_.
-    int center_;
-    int size_;
+    /// subtree. However, the intervals overlapping with the center position are stored in the node.
+    QVector<int> intervals_;
+};
+
+/// Java-style iterator over the indices of the intervals overlapping [start, stop] (see IntervalTree::overlapIterator()).
+/// Matches are determined lazily while iterating, in the same order as IntervalTree::overlappingIntervals() reports them.
+/// The iterator does not allocate memory unless the tree is extremely deep. It is invalidated when the tree is destroyed.
+template <class T>
+class IntervalTreeOverlapIterator
+{
+public:
+    /// Constructor. @p data may be null for an empty tree.
+    IntervalTreeOverlapIterator(const IntervalTreeData<T>* data, int start, int stop);
 
+    /// Returns true if there is another overlapping interval.
+    bool hasNext() const
+    {
+        return next_ != -1;
+    }
+
+    /// Returns the index of the next overlapping interval and advances the iterator.
+    int next()
+    {
+        int index = next_;
+        advance();
+        return index;
+    }
+
+private:
+    /// Searches the next overlapping interval.
+    void advance();
+
+    const IntervalTreeData<T>* data_;
+    int start_;
+    int stop_;
+    /// Current node (-1 if the search is finished) and position in the interval indices
+    int node_;
+    int position_;
+    /// Nodes that are still to be searched
+    QVarLengthArray<int, 64> pending_;
+    /// Index of the next overlapping interval, or -1
+    int next_;
 };
 
 /// The shared interval tree class, which contains a pointer to the actual tree data and a reference count to allow for implicit sharing.
@@ -148,6 +208,8 @@ class CPPCORESHARED_EXPORT IntervalTree
 {
 public:
     IntervalTree();
+    /// Constructor. Sorts @p indices by start position and builds the tree over the given intervals of the container.
+    /// The extent parameters are not needed to build the tree and are only kept for backward compatibility.
     IntervalTree(const T& container,
                  std::list<int> &indices,
                  int leftextent = 0,
@@ -157,23 +219,92 @@ public:
     IntervalTree(const IntervalTree& other);
 
     /// Returns true if the tree is empty
-    bool isEmpty() { return !d_; }
+    bool isEmpty() const { return !d_; }
 
     /// Determine the overlapping intervals of [start, stop] in the interval tree. If stop_at_first_match is true,
     /// only the first overlapping interval is returned
     void overlappingIntervals(int start, int stop, QVector<int>& matches, bool stop_at_first_match=false) const;
+    /// Calls @p visitor with the index of each interval overlapping [start, stop], without collecting the matches.
+    /// The visitor returns false to stop the query. Returns false if the query was stopped by the visitor.
+    template <typename Visitor>
+    bool visitOverlappingIntervals(int start, int stop, Visitor visitor) const;
+    /// Returns an iterator over the indices of the intervals overlapping [start, stop].
+    IntervalTreeOverlapIterator<T> overlapIterator(int start, int stop) const;
 
     void subtractTree(const IntervalTree& other,QVector<Interval>& remaining_intervals) const;
 
     void allIntervals(QVector<Interval>& intervals) const;
 
+    /// Returns the index of the interval closest to @p pos, or -1 if the tree is empty. Overlapping intervals have distance 0,
+    /// otherwise the distance is the difference between @p pos and the closest interval boundary, i.e. an adjacent interval has distance 1.
+    /// If an upstream and a downstream interval have the same distance, the upstream interval is returned.
+    int nearestInterval(int pos, int& distance) const;
+    /// Returns the index of the closest interval that ends before @p pos, or -1 if there is no such interval. The distance is @p pos minus the interval end.
+    int nearestUpstream(int pos, int& distance) const;
+    /// Returns the index of the closest interval that starts after @p pos, or -1 if there is no such interval. The distance is the interval start minus @p pos.
+    int nearestDownstream(int pos, int& distance) const;
+    /// Determines the (at most) @p k intervals closest to @p pos, ordered by increasing distance (as in nearestInterval). Overlapping intervals come first.
+    void nearestIntervals(int pos, int k, QVector<int>& matches, QVector<int>& distances) const;
+
 
 private:
+    friend class IntervalTreeCursor<T>;
+
+    /// Returns the position in by_end_ of the last interval that ends before @p pos, or -1.
+    int lastEndingBefore(int pos) const;
+    /// Returns the position in by_start_ of the first interval that starts after @p pos, or by_start_.count().
+    int firstStartingAfter(int pos) const;
+
     /// Shared pointer to the actual tree to support implicit sharing
     QSharedDataPointer<IntervalTreeData<T> > d_;
 
     /// Number intervals in tree
     int size_;
+
+    /// The interval container (needed for the nearest interval queries)
+    const T* container_;
+    /// Interval indices sorted by start position
+    QVector<int> by_start_;
+    /// Interval indices sorted by end position
+    QVector<int> by_end_;
+};
+
+/// Stateful query cursor for streams of overlap queries along the sequence, e.g. when annotating sorted records.
+/// The cursor keeps the intervals overlapping the last query (active set) and the position of the next interval in start order.
+/// If the start of a query is not smaller than the start of the previous query, only the intervals that end before the query
+/// are removed and the intervals starting up to the query end are added, i.e. monotone query streams take amortized constant time
+/// per query (plus the number of active intervals). Queries that go backwards or jump far ahead fall back to a normal tree search.
+template <class T>
+class IntervalTreeCursor
+{
+public:
+    /// Constructor. The tree is shared (see IntervalTree copy constructor), i.e. the container must stay valid while the cursor is used.
+    IntervalTreeCursor(const IntervalTree<T>& tree);
+
+    /// Determine the overlapping intervals of [start, stop], ordered by start position.
+    void overlappingIntervals(int start, int stop, QVector<int>& matches);
+    /// Forgets the previous query, i.e. the next query performs a normal tree search.
+    void reset()
+    {
+        valid_ = false;
+    }
+
+private:
+    /// Number of intervals that are scanned at most before falling back to a normal tree search
+    enum { FALLBACK_DISTANCE = 64 };
+
+    /// Initializes the active set and the next interval position with a normal tree search.
+    void seek(int start, int stop);
+
+    IntervalTree<T> tree_;
+    /// Intervals that overlapped the last query, ordered by start position
+    QVector<int> active_;
+    /// Position in the intervals sorted by start position of the first interval that was not added to the active set
+    int next_;
+    /// Start position of the last query
+    int last_start_;
+    /// Flag that indicates that the active set is valid
+    bool valid_;
 };
 
 
@@ -181,287 +312,293 @@ private:
 /// Default constructor.
 template <class T>
 IntervalTreeData<T>::IntervalTreeData()
+    : container_(0)
 {
-    //    QTextStream outstream(stdout);
-    //    outstream << "IntervalTreeData::IntervalTreeData default constructor " << endl;
 }
 
 
-/// Constructor to build the tree recursively upon a some intervals (given an interval container and a list of indices).
+/// Constructor to build the tree upon some intervals (given an interval container and the indices sorted by start position).
 template <class T>
-IntervalTreeData<T>::IntervalTreeData(const T& container,
-                                      std::list<int>& indices,
-                                      std::list<int>::iterator indices_start,
-                                      std::list<int>::iterator indices_end,
-                                      int leftextent,
-                                      int rightextent)
-    : container_(container),
-      center_(0)
+IntervalTreeData<T>::IntervalTreeData(const T& container, const QVector<int>& sorted_indices)
+    : container_(&container)
 {
-    //    QTime timer;
-    //    QTextStream outstream(stdout);
+    nodes_.reserve(sorted_indices.count());
+    intervals_.reserve(sorted_indices.count());
+    QVector<int> work = sorted_indices;
+    build(work, 0, work.count());
+}
 
-    int leftp = 0;
-    int rightp = 0;
-    int centerp = 0;
 
-    if (leftextent || rightextent)
+/// Copy constructor in case that the data are edited and the data need to be copied "deeply" (copies two arrays).
+template <class T>
+IntervalTreeData<T>::IntervalTreeData(const IntervalTreeData &other)
+    : QSharedData(other),
+      container_(other.container_),
+      nodes_(other.nodes_),
+      intervals_(other.intervals_)
+{
+}
+
+/// Build the tree recursively. The node is created before its sub trees, so the nodes are stored in pre-order.
+template <class T>
+int IntervalTreeData<T>::build(QVector<int>& work, int begin, int end)
+{
+    if (begin >= end)
     {
-        leftp = leftextent;
-        rightp = rightextent;
+        return -1;
     }
-    else
+    const T& container = *container_;
+
+    // the center position is the start position of the median interval
+    int node = nodes_.count();
+    nodes_.append(Node());
+    nodes_[node].center = container[work[begin + (end-begin)/2]].start();
+    nodes_[node].first = intervals_.count();
+
+    // assign the intervals overlapping the center position to the node. Intervals left of the center position are moved to the front
+    // of the range. We can stop at the first interval which starts right of the center position, all following intervals are right of it, too.
+    int left_end = begin;
+    int right_start = begin;
+    while (right_start < end && container[work[right_start]].start() <= nodes_[node].center)
     {
-        // timer.restart();
-        leftp = container_[*indices_start].start();
-        rightp = container_[*(std::max_element(indices_start, indices_end, MaxEndPositionContainer<T>(container_)))].end();
-        // outstream <<"determine max end element" + Helper::elapsedTime(timer) << endl;
-    }
-
-    // determine the center position (unfortunately list does not support direct access to the elements by position
-    // timer.restart();
-    int number_intervals = std::distance(indices_start, indices_end);
-    int center_index = number_intervals/2;
-    std::list<int>::iterator it = indices_start;
-    while (center_index > 0)
-    {
-        ++it;
-        --center_index;
-    }
-    centerp = container_[*it].start();
-    center_ = centerp;
-    //outstream <<"find center position " + Helper::elapsedTime(timer) << endl;
-
-
-    // iterate through the defined range of the list
-    it = indices_start;
-    // iterators, which define the range of intervals left to the center start position
-    std::list<int>::iterator left_start = indices_start;
-    std::list<int>::iterator left_end = indices_start;
-    // iterators, which define the range of intervals right to the center start position
-    std::list<int>::iterator right_start = indices_end;
-    std::list<int>::iterator right_end = indices_end;
-    // stop when either we've seen all intervals or if we have already found the first interval which is right of
-    // the center start position
-    // timer.restart();
-    while ((it != indices_end) &&  (right_start == indices_end))
-    {
-        int index =*it;
-        if (container_[index].end() < center_)
+        int index = work[right_start];
+        if (container[index].end() < nodes_[node].center)
         {
-            left_end=it;
+            work[left_end] = index;
             ++left_end;
         }
         else
         {
-            if (container_[index].start() > center_)
-            {
-                right_start = it;
-            }
-            else
-            {
-                // assign the interval to the current node of the tree, since it overlaps the center start position
-                // outstream << " append Interval " << endl;
-                intervals_.append(index);
-                //outstream << " append Interval done " << endl;
-                bool removed_left_start = (it == left_start);
-                bool removed_left_end = (it == left_end);
-                // and remove it from the list
-                it=indices.erase(it);
-                // if the first element was removed, we need to redefine the iterators of the left range
-                if (removed_left_start)
-                {
-                    left_start=it;
-                }
-                if (removed_left_end)
-                {
-                    left_end=it;
-                }
-                // don't increment the iterator again, since after the removal of "it" the iterator
-                // points to the next element
-                continue;
-            }
+            intervals_.append(index);
         }
-        ++it;
+        ++right_start;
     }
-    //outstream <<"categorize intervals " + Helper::elapsedTime(timer) << endl;
+    nodes_[node].count = intervals_.count() - nodes_[node].first;
 
-    if (left_start != left_end)
-    {
-        //timer.restart();
-        left_.reset(new IntervalTreeData(container, indices, left_start, left_end, leftp, centerp));
-        // outstream << "recursive left sub tree" +  Helper::elapsedTime(timer) << endl;
-    }
-    if (right_start != right_end)
-    {
-        //timer.restart();
-        right_.reset(new IntervalTreeData(container, indices, right_start, right_end, centerp, rightp));
-        // outstream << "recursive left sub tree" +  Helper::elapsedTime(timer) << endl;
-    }
+    int left = build(work, begin, left_end);
+    int right = build(work, right_start, end);
+    nodes_[node].left = left;
+    nodes_[node].right = right;
 
+    return node;
 }
 
-
-/// Copy constructor in case that the data are edited and the data need to be copied "deeply".
+/// Determine the overlapping intervals of the [start, stop]. If stop_at_first_match is set true, only the first overlapping interval is returned.
 template <class T>
-IntervalTreeData<T>::IntervalTreeData(const IntervalTreeData &other)
-    : QSharedData(other),
-      intervals_(other.intervals_),
-      center_(other.center_)
+void IntervalTreeData<T>::findOverlappingIntervals(int start, int stop, QVector<int>& matches, bool stop_at_first_match) const
 {
-    //    QTextStream outstream(stdout);
-    //    outstream << "IntervalTreeData::IntervalTreeData copy constructor " << endl;
-
-    if (!other.left_.isNull())
+    auto collect = [&matches, stop_at_first_match](int index)
     {
-        left_.reset(new IntervalTreeData(*other.left_));
-    }
-    if (!other.right_.isNull())
+        matches.append(index);
+        return !stop_at_first_match;
+    };
+    visitOverlappingIntervals(start, stop, collect);
+}
+
+/// Call the visitor for the overlapping intervals of [start, stop], starting at the root node.
+template <class T>
+template <typename Visitor>
+bool IntervalTreeData<T>::visitOverlappingIntervals(int start, int stop, Visitor& visitor) const
+{
+    if (nodes_.isEmpty())
     {
-        right_.reset(new IntervalTreeData(*other.right_));
+        return true;
     }
+    return visitNode(0, start, stop, visitor);
 }
 
-/// Determine recursively the overlapping intervals of the [start, stop]. If stop_at_first_match is set true, only the first overlapping interval is returned.
+/// Call the visitor recursively for the overlapping intervals of [start, stop]. The intervals of a node are sorted by start position.
 template <class T>
-void IntervalTreeData<T>::findOverlappingIntervals(int start, int stop, QVector<int>& matches, bool stop_at_first_match) const
+template <typename Visitor>
+bool IntervalTreeData<T>::visitNode(int node, int start, int stop, Visitor& visitor) const
 {
-    if (!intervals_.empty() && ! (stop < container_[intervals_.front()].start()))
+    const T& container = *container_;
+    const Node& n = nodes_[node];
+    for (int i=n.first; i<n.first+n.count; ++i)
     {
-        foreach (const int& index, intervals_)
+        int index = intervals_[i];
+        if (container[index].start() > stop)
         {
-            if (container_[index].end() >= start && container_[index].start() <= stop)
-            {
-                matches.append(index);
-                if (stop_at_first_match)
-                {
-                    return;
-                }
-            }
+            break;
+        }
+        if (container[index].end() >= start && !visitor(index))
+        {
+            return false;
         }
     }
 
-    if (!left_.isNull() && start <= center_)
+    if (n.left != -1 && start <= n.center && !visitNode(n.left, start, stop, visitor))
     {
-        left_->findOverlappingIntervals(start, stop, matches, stop_at_first_match);
+        return false;
     }
 
-    if (!right_.isNull() && stop >= center_)
+    if (n.right != -1 && stop >= n.center && !visitNode(n.right, start, stop, visitor))
     {
-        right_->findOverlappingIntervals(start, stop, matches, stop_at_first_match);
+        return false;
     }
+
+    return true;
 }
 
-/// Subtract recursively the other interval tree from this interval tree.
+/// Subtract the other interval tree from this interval tree (the intervals are processed in the pre-order of the nodes).
 template <class T>
 void IntervalTreeData<T>::subtractTree(const IntervalTreeData& other, QVector<Interval>& remaining_intervals) const
 {
-    const T& container_other = other.container_;
-    if (!intervals_.empty())
+    if (intervals_.isEmpty())
     {
-        foreach (const int& index, intervals_)
+        return;
+    }
+    const T& container = *container_;
+
+    foreach (const int& index, intervals_)
+    {
+        QVector<int> overlapping_intervals;
+        int start_this = container[index].start();
+        int stop_this = container[index].end();
+        other.findOverlappingIntervals(start_this, stop_this, overlapping_intervals);
+
+        if (!overlapping_intervals.empty())
         {
+            const T& container_other = *other.container_;
+            std::sort(overlapping_intervals.begin(),overlapping_intervals.end(),MinStartPositionContainer<T>(container_other));
 
-            QVector<int> overlapping_intervals;
-            int start_this = container_[index].start();
-            int stop_this = container_[index].end();
-            other.findOverlappingIntervals(start_this, stop_this, overlapping_intervals);
-            std::sort(overlapping_intervals.begin(),overlapping_intervals.end(),MinStartPositionContainer<T>(other.container_));
+            int start_other=container_other[overlapping_intervals[0]].start();
+            int stop_other=container_other[overlapping_intervals[0]].end();
+            int i=1;
 
-            if (!overlapping_intervals.empty())
+            // proceed until either the whole current_merged interval is subtracted or all overlapping intervals are processed
+            while ((start_this < stop_this) && (i < overlapping_intervals.count()))
             {
-                int start_other=container_other[overlapping_intervals[0]].start();
-                int stop_other=container_other[overlapping_intervals[0]].end();
-                int i=1;
-
-                // proceed until either the whole current_merged interval is subtracted or all overlapping intervals are processed
-                while ((start_this < stop_this) && (i < overlapping_intervals.count()))
+                int index_other = overlapping_intervals[i];
+                // go ahead if the matching interval of other is covered by the current interval
+                if (container_other[index_other].end() <= stop_other)
                 {
-                    int index_other = overlapping_intervals[i];
-                    // go ahead if the matching interval of other is covered by the current interval
-                    if (container_other[index_other].end() <= stop_other)
-                    {
-                        ++i;
-                        continue;
-                    }
-                    // merge the current and the next interval if they overlap
-                    if (container_other[index_other].start() <= stop_other)
-                    {
-                        stop_other = container_other[index_other].end();
-                        ++i;
-                        continue;
-                    }
-
-                    // left part is remaining
-                    if (start_other > start_this)
-                    {
-                        //create new region (left part)
-                        remaining_intervals.append(Interval(start_this,start_other-1,-1));
-                    }
-                    start_this=stop_other;
-                    start_other=container_other[index_other].start();
-                    stop_other=container_other[index_other].end();
                     ++i;
+                    continue;
                 }
+                // merge the current and the next interval if they overlap
+                if (container_other[index_other].start() <= stop_other)
+                {
+                    stop_other = container_other[index_other].end();
+                    ++i;
+                    continue;
+                }
+
                 // left part is remaining
                 if (start_other > start_this)
                 {
                     //create new region (left part)
                     remaining_intervals.append(Interval(start_this,start_other-1,-1));
                 }
-                // create new region for the remaining right part of the interval
-                if (stop_other < stop_this)
-                {
-                    remaining_intervals.append(Interval(stop_other+1,stop_this,-1));
-                }
-
+                start_this=stop_other;
+                start_other=container_other[index_other].start();
+                stop_other=container_other[index_other].end();
+                ++i;
+            }
+            // left part is remaining
+            if (start_other > start_this)
+            {
+                //create new region (left part)
+                remaining_intervals.append(Interval(start_this,start_other-1,-1));
             }
-            // if no overlapping intervals exisit in other nothing is subtracted
-            else
+            // create new region for the remaining right part of the interval
+            if (stop_other < stop_this)
             {
-                remaining_intervals.append(Interval(container_[index].start(), container_[index].end(), index));
+                remaining_intervals.append(Interval(stop_other+1,stop_this,-1));
             }
+
+        }
+        // if no overlapping intervals exisit in other nothing is subtracted
+        else
+        {
+            remaining_intervals.append(Interval(container[index].start(), container[index].end(), index));
         }
     }
+}
 
-    if (!left_.isNull())
+/// Return all intervals (value is the index in the container), sorted by start position.
+template <class T>
+void IntervalTreeData<T>::allIntervals(QVector<Interval>& intervals) const
+{
+    if (intervals_.isEmpty())
     {
-        left_->subtractTree(other, remaining_intervals);
+        return;
     }
+    const T& container = *container_;
 
-    if (!right_.isNull())
+    int first = intervals.count();
+    foreach (int index, intervals_)
     {
-        right_->subtractTree(other, remaining_intervals);
+        intervals.append(Interval(container[index].start(), container[index].end(), index));
     }
+    std::stable_sort(intervals.begin()+first, intervals.end(), MinStartPositionInterval());
+}
 
-
+/// Constructor of the overlap iterator (searches the first match).
+template <class T>
+IntervalTreeOverlapIterator<T>::IntervalTreeOverlapIterator(const IntervalTreeData<T>* data, int start, int stop)
+    : data_(data)
+    , start_(start)
+    , stop_(stop)
+    , node_((data != 0 && !data->nodes_.isEmpty()) ? 0 : -1)
+    , position_(0)
+    , next_(-1)
+{
+    advance();
 }
 
-/// Iterate recursively through the tree and return all intervals.
+/// Depth-first search with an explicit stack: intervals of the node, then left sub tree, then right sub tree.
 template <class T>
-void IntervalTreeData<T>::allIntervals(QVector<Interval>& intervals) const
+void IntervalTreeOverlapIterator<T>::advance()
 {
-    if (left_.isNull())
+    next_ = -1;
+    while (node_ != -1)
     {
-        foreach(const Interval& interval, intervals_)
+        const typename IntervalTreeData<T>::Node& node = data_->nodes_[node_];
+        const T& container = *data_->container_;
+        const int node_end = node.first + node.count;
+        while (position_ < node_end)
         {
-            intervals.append(interval);
+            int index = data_->intervals_[position_];
+            ++position_;
+            if (container[index].start() > stop_)
+            {
+                position_ = node_end;
+                break;
+            }
+            if (container[index].end() >= start_)
+            {
+                next_ = index;
+                return;
+            }
         }
-        if (!right_.isNull())
+
+        // push the right sub tree first, so the left sub tree is searched first
+        if (node.right != -1 && stop_ >= node.center)
         {
-            right_->allIntervals(intervals);
+            pending_.append(node.right);
+        }
+        if (node.left != -1 && start_ <= node.center)
+        {
+            pending_.append(node.left);
         }
-    }
-    else
-    {
-        left_->allIntervals(intervals);
-    }
 
+        if (pending_.isEmpty())
+        {
+            node_ = -1;
+        }
+        else
+        {
+            node_ = pending_.last();
+            pending_.removeLast();
+            position_ = data_->nodes_[node_].first;
+        }
+    }
 }
 
 /// Default constructor of the interval tree.
 template <class T>
-IntervalTree<T>::IntervalTree() : d_(), size_(0)
+IntervalTree<T>::IntervalTree() : d_(), size_(0), container_(0)
 {
     //    QTextStream outstream(stdout);
     //    outstream << "IntervalTree default constructor"  << endl;
@@ -471,23 +608,38 @@ IntervalTree<T>::IntervalTree() : d_(), size_(0)
 template <class T>
 IntervalTree<T>::IntervalTree(const T& container,
                               std::list<int>& indices,
-                              int leftextent,
-                              int rightextent)
+                              int /*leftextent*/,
+                              int /*rightextent*/)
     : size_(indices.size())
+    , container_(&container)
 {
     //    QTextStream outstream(stdout);
     //    QTime timer;
     //    timer.start();
     indices.sort(MinStartPositionContainer<T>(container));
     //outstream << "sort all intervals " +  Helper::elapsedTime(timer) << endl;
+
+    // keep the sorted orders for the nearest interval queries
+    by_start_.reserve(size_);
+    for (std::list<int>::const_iterator it=indices.begin(); it!=indices.end(); ++it)
+    {
+        by_start_.append(*it);
+    }
+    by_end_ = by_start_;
+    std::stable_sort(by_end_.begin(), by_end_.end(), MaxEndPositionContainer<T>(container));
     //    timer.restart();
-    d_ = new IntervalTreeData<T>(container, indices, indices.begin(), indices.end(), leftextent, rightextent);
+    d_ = new IntervalTreeData<T>(container, by_start_);
     //outstream << "build tree end" +  Helper::elapsedTime(timer) << endl;
 }
 
 /// Copy constructor of the interval tree.
 template <class T>
-IntervalTree<T>::IntervalTree(const IntervalTree<T>& other) : d_(other.d_), size_(other.size_)
+IntervalTree<T>::IntervalTree(const IntervalTree<T>& other)
+    : d_(other.d_)
+    , size_(other.size_)
+    , container_(other.container_)
+    , by_start_(other.by_start_)
+    , by_end_(other.by_end_)
 {
     //    QTextStream outstream(stdout);
     //    outstream << "IntervalTree copy constructor"  << endl;
@@ -501,6 +653,25 @@ void IntervalTree<T>::overlappingIntervals(int start, int stop, QVector<int>& ma
     d_->findOverlappingIntervals(start,stop,matches,stop_at_first_match);
 }
 
+/// Call the visitor for the overlapping intervals of [start, stop] (no matches are collected).
+template <class T>
+template <typename Visitor>
+bool IntervalTree<T>::visitOverlappingIntervals(int start, int stop, Visitor visitor) const
+{
+    if (!d_)
+    {
+        return true;
+    }
+    return d_->visitOverlappingIntervals(start, stop, visitor);
+}
+
+/// Create a lazy iterator over the overlapping intervals of [start, stop].
+template <class T>
+IntervalTreeOverlapIterator<T> IntervalTree<T>::overlapIterator(int start, int stop) const
+{
+    return IntervalTreeOverlapIterator<T>(d_.constData(), start, stop);
+}
+
 /// Subtract recursively the other interval tree from this interval tree.
 template <class T>
 void IntervalTree<T>::subtractTree(const IntervalTree& other, QVector<Interval>& remaining_intervals) const
@@ -521,5 +692,227 @@ void IntervalTree<T>::allIntervals(QVector<Interval>& intervals) const
 
 }
 
+/// Binary search in the intervals sorted by end position.
+template <class T>
+int IntervalTree<T>::lastEndingBefore(int pos) const
+{
+    int lower = 0;
+    int upper = by_end_.count();
+    while (lower < upper)
+    {
+        int middle = lower + (upper-lower)/2;
+        if ((*container_)[by_end_[middle]].end() < pos)
+        {
+            lower = middle + 1;
+        }
+        else
+        {
+            upper = middle;
+        }
+    }
+    return lower - 1;
+}
+
+/// Binary search in the intervals sorted by start position.
+template <class T>
+int IntervalTree<T>::firstStartingAfter(int pos) const
+{
+    int lower = 0;
+    int upper = by_start_.count();
+    while (lower < upper)
+    {
+        int middle = lower + (upper-lower)/2;
+        if ((*container_)[by_start_[middle]].start() <= pos)
+        {
+            lower = middle + 1;
+        }
+        else
+        {
+            upper = middle;
+        }
+    }
+    return lower;
+}
+
+/// Determine the closest upstream interval (logarithmic time).
+template <class T>
+int IntervalTree<T>::nearestUpstream(int pos, int& distance) const
+{
+    int i = lastEndingBefore(pos);
+    if (i < 0)
+    {
+        return -1;
+    }
+    distance = pos - (*container_)[by_end_[i]].end();
+    return by_end_[i];
+}
+
+/// Determine the closest downstream interval (logarithmic time).
+template <class T>
+int IntervalTree<T>::nearestDownstream(int pos, int& distance) const
+{
+    int i = firstStartingAfter(pos);
+    if (i >= by_start_.count())
+    {
+        return -1;
+    }
+    distance = (*container_)[by_start_[i]].start() - pos;
+    return by_start_[i];
+}
+
+/// Determine the closest interval (logarithmic time).
+template <class T>
+int IntervalTree<T>::nearestInterval(int pos, int& distance) const
+{
+    if (by_start_.isEmpty())
+    {
+        return -1;
+    }
+
+    // overlapping interval (the visitor stops at the first match, so nothing is allocated)
+    int overlapping = -1;
+    auto first = [&overlapping](int index)
+    {
+        overlapping = index;
+        return false;
+    };
+    d_->visitOverlappingIntervals(pos, pos, first);
+    if (overlapping != -1)
+    {
+        distance = 0;
+        return overlapping;
+    }
+
+    // closest non-overlapping interval
+    int distance_up = 0;
+    int distance_down = 0;
+    int up = nearestUpstream(pos, distance_up);
+    int down = nearestDownstream(pos, distance_down);
+    if (up!=-1 && (down==-1 || distance_up <= distance_down))
+    {
+        distance = distance_up;
+        return up;
+    }
+    distance = distance_down;
+    return down;
+}
+
+/// Determine the k closest intervals by walking outwards from the query position in both sorted orders.
+template <class T>
+void IntervalTree<T>::nearestIntervals(int pos, int k, QVector<int>& matches, QVector<int>& distances) const
+{
+    matches.clear();
+    distances.clear();
+    if (by_start_.isEmpty() || k <= 0)
+    {
+        return;
+    }
+
+    // overlapping intervals
+    d_->findOverlappingIntervals(pos, pos, matches);
+    if (matches.count() > k)
+    {
+        matches.resize(k);
+    }
+    distances.fill(0, matches.count());
+
+    // merge upstream and downstream intervals by distance
+    int up = lastEndingBefore(pos);
+    int down = firstStartingAfter(pos);
+    while (matches.count() < k && (up >= 0 || down < by_start_.count()))
+    {
+        int distance_up = up >= 0 ? pos - (*container_)[by_end_[up]].end() : 0;
+        int distance_down = down < by_start_.count() ? (*container_)[by_start_[down]].start() - pos : 0;
+        if (up >= 0 && (down >= by_start_.count() || distance_up <= distance_down))
+        {
+            matches.append(by_end_[up]);
+            distances.append(distance_up);
+            --up;
+        }
+        else
+        {
+            matches.append(by_start_[down]);
+            distances.append(distance_down);
+            ++down;
+        }
+    }
+}
+
+
+/// Constructor of the query cursor.
+template <class T>
+IntervalTreeCursor<T>::IntervalTreeCursor(const IntervalTree<T>& tree)
+    : tree_(tree)
+    , next_(0)
+    , last_start_(0)
+    , valid_(false)
+{
+}
+
+/// Determine the overlapping intervals incrementally from the last query, or with a normal search for backward or far queries.
+template <class T>
+void IntervalTreeCursor<T>::overlappingIntervals(int start, int stop, QVector<int>& matches)
+{
+    matches.clear();
+    if (tree_.by_start_.isEmpty())
+    {
+        return;
+    }
+    const T& container = *tree_.container_;
+    const QVector<int>& by_start = tree_.by_start_;
+
+    if (!valid_ || start < last_start_ || (next_ + FALLBACK_DISTANCE < by_start.count() && container[by_start[next_ + FALLBACK_DISTANCE]].start() <= stop))
+    {
+        seek(start, stop);
+    }
+    else
+    {
+        // remove intervals that end before the query (the following queries do not start before this query)
+        int kept = 0;
+        for (int i=0; i<active_.count(); ++i)
+        {
+            if (container[active_[i]].end() >= start)
+            {
+                active_[kept] = active_[i];
+                ++kept;
+            }
+        }
+        active_.resize(kept);
+
+        // add intervals that start before the query ends
+        while (next_ < by_start.count() && container[by_start[next_]].start() <= stop)
+        {
+            if (container[by_start[next_]].end() >= start)
+            {
+                active_.append(by_start[next_]);
+            }
+            ++next_;
+        }
+    }
+    last_start_ = start;
+
+    // active intervals can start after the query end, if the previous query ended further right
+    foreach (int index, active_)
+    {
+        if (container[index].start() > stop)
+        {
+            break;
+        }
+        matches.append(index);
+    }
+}
+
+/// Initialize the cursor with a normal tree search.
+template <class T>
+void IntervalTreeCursor<T>::seek(int start, int stop)
+{
+    active_.clear();
+    // constData() does not detach the shared tree data (the non-const operator-> would deep-copy it)
+    tree_.d_.constData()->findOverlappingIntervals(start, stop, active_);
+    std::sort(active_.begin(), active_.end(), MinStartPositionContainer<T>(*tree_.container_));
+    next_ = tree_.firstStartingAfter(stop);
+    valid_ = true;
+}
+
 
 #endif
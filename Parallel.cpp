@@ -0,0 +1,25 @@
+#include "Parallel.h"
+#include <QThread>
+#include <QMutex>
+#include <algorithm>
+
+int Parallel::idealThreadCount()
+{
+	return std::max(1, QThread::idealThreadCount());
+}
+
+int Parallel::threadCount(int count, int threads)
+{
+	if (threads<=0) threads = idealThreadCount();
+	return std::max(1, std::min(threads, count));
+}
+
+QThreadPool& Parallel::threadPool(int threads)
+{
+	static QThreadPool pool;
+	static QMutex mutex;
+
+	QMutexLocker locker(&mutex);
+	if (pool.maxThreadCount()<threads) pool.setMaxThreadCount(threads);
+	return pool;
+}
@@ -0,0 +1,132 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "cppCORE_global.h"
+#include <QThreadPool>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <exception>
+#include <memory>
+#include <vector>
+
+///Helper for simple data-parallel loops on a private thread pool that is shared by all loops.
+class CPPCORESHARED_EXPORT Parallel
+{
+public:
+	///Returns the number of processor cores, i.e. the number of threads used if no thread count is given.
+	static int idealThreadCount();
+	///Returns the number of worker threads that forEach() uses for @p count items, when @p threads threads are requested (non-positive values mean 'all cores').
+	static int threadCount(int count, int threads=0);
+
+	/**
+	  @brief Calls @p func(index, worker) for all indices in [0, count).
+
+	  Indices are handed out dynamically, so items with very different run-time are balanced automatically.
+	  @p worker is in [0, threadCount(count, threads)) and can be used to address per-thread scratch buffers.
+	  @p func is called concurrently from several threads and must be thread-safe.
+	  The calling thread is worker 0, the other workers run on the shared pool. If only one worker is needed, everything is executed in the calling thread.
+	  The first exception thrown by @p func is re-thrown in the calling thread after all workers have stopped.
+	*/
+	template <typename Func>
+	static void forEach(int count, Func func, int threads=0);
+
+protected:
+	///Constructor declared away.
+	Parallel();
+
+	///Returns the shared thread pool. Its maximum thread count is raised to @p threads if necessary.
+	static QThreadPool& threadPool(int threads);
+
+	///Worker that processes indices until all are consumed.
+	template <typename Func>
+	class Task
+		: public QRunnable
+	{
+	public:
+		Task(Func& func, int count, int worker, QAtomicInt& next, QMutex& mutex, std::exception_ptr& error, QSemaphore& finished)
+			: func_(func)
+			, count_(count)
+			, worker_(worker)
+			, next_(next)
+			, mutex_(mutex)
+			, error_(error)
+			, finished_(finished)
+		{
+			setAutoDelete(false);
+		}
+
+		void run()
+		{
+			try
+			{
+				int index;
+				while ((index = next_.fetchAndAddRelaxed(1)) < count_)
+				{
+					func_(index, worker_);
+				}
+			}
+			catch (...)
+			{
+				QMutexLocker locker(&mutex_);
+				if (!error_) error_ = std::current_exception();
+
+				//make the other workers stop
+				next_.fetchAndStoreRelaxed(count_);
+			}
+			finished_.release();
+		}
+
+	protected:
+		Func& func_;
+		int count_;
+		int worker_;
+		QAtomicInt& next_;
+		QMutex& mutex_;
+		std::exception_ptr& error_;
+		QSemaphore& finished_;
+	};
+};
+
+template <typename Func>
+void Parallel::forEach(int count, Func func, int threads)
+{
+	const int workers = threadCount(count, threads);
+	if (workers<=1)
+	{
+		for (int i=0; i<count; ++i)
+		{
+			func(i, 0);
+		}
+		return;
+	}
+
+	QAtomicInt next(0);
+	QMutex mutex;
+	std::exception_ptr error;
+	QSemaphore finished;
+
+	//start workers 1 to n-1 on the shared pool and work as worker 0 in the calling thread
+	QThreadPool& pool = threadPool(workers - 1);
+	std::vector<std::unique_ptr<Task<Func> > > tasks;
+	for (int w=0; w<workers; ++w)
+	{
+		tasks.emplace_back(new Task<Func>(func, count, w, next, mutex, error, finished));
+		if (w>0) pool.start(tasks[w].get());
+	}
+	tasks[0]->run();
+
+	//take back workers that have not started yet (e.g. because the pool is busy with an enclosing loop), then wait for the others
+	int running = workers;
+	for (int w=1; w<workers; ++w)
+	{
+		if (pool.tryTake(tasks[w].get())) --running;
+	}
+	finished.acquire(running);
+
+	if (error) std::rethrow_exception(error);
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,152 @@
+#include "ParallelStatistics.h"
+#include "BasicStatistics.h"
+#include "StatisticsKernels.h"
+#include "Parallel.h"
+#include "Exceptions.h"
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+double ParallelStatistics::mean(const QVector<double>& data, int threads, int serial_threshold)
+{
+	const int n = data.count();
+	if (n==0 || n<serial_threshold) return BasicStatistics::mean(data);
+
+	return sum(data.constData(), n, threads) / n;
+}
+
+double ParallelStatistics::stdev(const QVector<double>& data, int threads, int serial_threshold)
+{
+	const int n = data.count();
+	if (n==0 || n<serial_threshold) return BasicStatistics::stdev(data);
+
+	const double* values = data.constData();
+	const double mean = sum(values, n, threads) / n;
+
+	QVector<double> partials(blockCount(n));
+	double* out = partials.data();
+	Parallel::forEach(partials.count(), [values, n, mean, out](int b, int /*worker*/)
+	{
+		const int start = b * BLOCK_SIZE;
+		out[b] = StatisticsKernels::sumSquaredDeviations(values + start, std::min(n - start, (int)BLOCK_SIZE), mean);
+	}, threads);
+
+	return sqrt(pairwiseSum(partials.constData(), partials.count()) / n);
+}
+
+double ParallelStatistics::correlation(const QVector<double>& x, const QVector<double>& y, int threads, int serial_threshold)
+{
+	const int n = x.count();
+	if (n!=y.count() || n==0 || n<serial_threshold) return BasicStatistics::correlation(x, y);
+
+	const double* x_values = x.constData();
+	const double* y_values = y.constData();
+	const double x_mean = sum(x_values, n, threads) / n;
+	const double y_mean = sum(y_values, n, threads) / n;
+
+	//partial sums of each block: sxx, syy, sxy
+	const int blocks = blockCount(n);
+	QVector<double> partials(3 * blocks);
+	double* out = partials.data();
+	Parallel::forEach(blocks, [x_values, y_values, n, x_mean, y_mean, blocks, out](int b, int /*worker*/)
+	{
+		const int start = b * BLOCK_SIZE;
+		StatisticsKernels::sumProducts(x_values + start, y_values + start, std::min(n - start, (int)BLOCK_SIZE), x_mean, y_mean, out[b], out[blocks + b], out[2*blocks + b]);
+	}, threads);
+
+	const double sxx = pairwiseSum(out, blocks);
+	const double syy = pairwiseSum(out + blocks, blocks);
+	const double sxy = pairwiseSum(out + 2*blocks, blocks);
+	return sxy / sqrt(sxx) / sqrt(syy);
+}
+
+QPair<double, double> ParallelStatistics::getMinMax(const QVector<double>& data, int threads, int serial_threshold)
+{
+	const int n = data.count();
+	if (n<serial_threshold) return BasicStatistics::getMinMax(data);
+
+	const double* values = data.constData();
+	const int blocks = blockCount(n);
+	QVector<double> partials(2 * blocks);
+	double* out = partials.data();
+	Parallel::forEach(blocks, [values, n, blocks, out](int b, int /*worker*/)
+	{
+		const int start = b * BLOCK_SIZE;
+		StatisticsKernels::validMinMax(values + start, std::min(n - start, (int)BLOCK_SIZE), out[b], out[blocks + b]);
+	}, threads);
+
+	double min = std::numeric_limits<double>::max();
+	double max = -std::numeric_limits<double>::max();
+	for (int b=0; b<blocks; ++b)
+	{
+		min = std::min(min, out[b]);
+		max = std::max(max, out[blocks + b]);
+	}
+	return qMakePair(min, max);
+}
+
+QPair<double, double> ParallelStatistics::linearRegression(const QVector<double>& x, const QVector<double>& y, int threads, int serial_threshold)
+{
+	const int n = x.count();
+	if (n<serial_threshold) return BasicStatistics::linearRegression(x, y);
+	if (y.count()<n)
+	{
+		THROW(StatisticsException, "Cannot calculate linear regression of data arrays with different length!");
+	}
+
+	//partial sums of each block: sum_x, sum_y, valid count
+	const double* x_values = x.constData();
+	const double* y_values = y.constData();
+	const int blocks = blockCount(n);
+	QVector<double> partials(3 * blocks);
+	double* out = partials.data();
+	Parallel::forEach(blocks, [x_values, y_values, n, blocks, out](int b, int /*worker*/)
+	{
+		const int start = b * BLOCK_SIZE;
+		out[2*blocks + b] = StatisticsKernels::validSums(x_values + start, y_values + start, std::min(n - start, (int)BLOCK_SIZE), out[b], out[blocks + b]);
+	}, threads);
+	const double sum_x = pairwiseSum(out, blocks);
+	const double sum_y = pairwiseSum(out + blocks, blocks);
+	const double count_valid = pairwiseSum(out + 2*blocks, blocks);
+	const double mean_x = sum_x / count_valid;
+
+	//partial sums of each block: squared deviations of x, y weighted by deviation of x
+	Parallel::forEach(blocks, [x_values, y_values, n, mean_x, blocks, out](int b, int /*worker*/)
+	{
+		const int start = b * BLOCK_SIZE;
+		StatisticsKernels::validRegressionSums(x_values + start, y_values + start, std::min(n - start, (int)BLOCK_SIZE), mean_x, out[b], out[blocks + b]);
+	}, threads);
+	const double sxx = pairwiseSum(out, blocks);
+	const double slope = pairwiseSum(out + blocks, blocks) / sxx;
+
+	return qMakePair((sum_y - sum_x*slope) / count_valid, slope);
+}
+
+double ParallelStatistics::pairwiseSum(const double* values, int n)
+{
+	if (n<=8)
+	{
+		double sum = 0.0;
+		for (int i=0; i<n; ++i)
+		{
+			sum += values[i];
+		}
+		return sum;
+	}
+
+	const int half = n / 2;
+	return pairwiseSum(values, half) + pairwiseSum(values + half, n - half);
+}
+
+double ParallelStatistics::sum(const double* data, int n, int threads)
+{
+	QVector<double> partials(blockCount(n));
+	double* out = partials.data();
+	Parallel::forEach(partials.count(), [data, n, out](int b, int /*worker*/)
+	{
+		const int start = b * BLOCK_SIZE;
+		out[b] = StatisticsKernels::sum(data + start, std::min(n - start, (int)BLOCK_SIZE));
+	}, threads);
+
+	return pairwiseSum(partials.constData(), partials.count());
+}
@@ -0,0 +1,51 @@
+#ifndef PARALLELSTATISTICS_H
+#define PARALLELSTATISTICS_H
+
+#include "cppCORE_global.h"
+#include <QVector>
+#include <QPair>
+
+/**
+  @brief Multi-threaded variants of the BasicStatistics reductions for very large arrays.
+
+  The data is split into blocks of fixed size, which are reduced in parallel with the vectorized kernels of StatisticsKernels.
+  The partial results of the blocks are combined by pairwise summation in block order, so the results do not depend on the number of threads.
+  Arrays with less than @p serial_threshold elements are processed by BasicStatistics in the calling thread (use 0 to always use the blocked reduction).
+  Non-positive @p threads values mean 'all cores', see Parallel.
+*/
+class CPPCORESHARED_EXPORT ParallelStatistics
+{
+public:
+	///Default array size below which the serial functions are used.
+	static const int DEFAULT_SERIAL_THRESHOLD = 1000000;
+
+	///Calculates the mean of the data, see BasicStatistics::mean().
+	static double mean(const QVector<double>& data, int threads=0, int serial_threshold=DEFAULT_SERIAL_THRESHOLD);
+	///Calculates the standard deviation of the data, see BasicStatistics::stdev().
+	static double stdev(const QVector<double>& data, int threads=0, int serial_threshold=DEFAULT_SERIAL_THRESHOLD);
+	///Calculates the correlation of two data arrays, see BasicStatistics::correlation().
+	static double correlation(const QVector<double>& x, const QVector<double>& y, int threads=0, int serial_threshold=DEFAULT_SERIAL_THRESHOLD);
+	///Returns minimum and maximum of a dataset, see BasicStatistics::getMinMax(). Ignores invalid values.
+	static QPair<double, double> getMinMax(const QVector<double>& data, int threads=0, int serial_threshold=DEFAULT_SERIAL_THRESHOLD);
+	///Returns the offset and slope of a linear regression, see BasicStatistics::linearRegression(). Ignores invalid values.
+	static QPair<double, double> linearRegression(const QVector<double>& x, const QVector<double>& y, int threads=0, int serial_threshold=DEFAULT_SERIAL_THRESHOLD);
+
+protected:
+	///Constructor declared away.
+	ParallelStatistics();
+
+	///Number of elements per block.
+	static const int BLOCK_SIZE = 65536;
+
+	///Returns the number of blocks of an array.
+	static int blockCount(int n)
+	{
+		return (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	}
+	///Returns the sum of the values using pairwise summation (the summation order depends only on the number of values).
+	static double pairwiseSum(const double* values, int n);
+	///Returns the sum of the data using a parallel blocked reduction.
+	static double sum(const double* data, int n, int threads);
+};
+
+#endif // PARALLELSTATISTICS_H
@@ -0,0 +1,310 @@
+#include "QuantileSketch.h"
+#include "Exceptions.h"
+#include <algorithm>
+
+namespace
+{
+	const char SKETCH_MAGIC[8] = {'C', 'P', 'P', 'Q', 'S', 'K', 'T', '\0'};
+	const quint32 SKETCH_VERSION = 1;
+	const quint32 SKETCH_BYTE_ORDER = 0x01020304;
+	const double PI = 3.14159265358979323846;
+
+	///Header of the binary representation, followed by the centroids (mean and weight).
+	struct SketchHeader
+	{
+		char magic[8];
+		quint32 version;
+		quint32 byte_order;
+		double compression;
+		double total;
+		double min;
+		double max;
+		quint64 centroid_count;
+	};
+
+	///Scale function of the t-digest: maps quantiles to centroid indices, so that centroids near the tails are small.
+	double scale(double q, double compression)
+	{
+		return compression / (2.0 * PI) * asin(2.0 * q - 1.0);
+	}
+
+	///Inverse of the scale function.
+	double inverseScale(double k, double compression)
+	{
+		return (sin(k * 2.0 * PI / compression) + 1.0) / 2.0;
+	}
+
+	///Returns the maximum cumulative weight of the centroid that starts at cumulative weight @p weight_before.
+	double weightLimit(double weight_before, double total, double compression)
+	{
+		//the scale function ends at compression/4 - beyond that, the inverse would wrap around and the limit would fall below the weight already placed
+		const double k = scale(weight_before / total, compression) + 1.0;
+		if (k>=compression/4.0) return total;
+
+		return inverseScale(k, compression) * total;
+	}
+}
+
+QuantileSketch::QuantileSketch(double compression)
+	: compression_(compression)
+	, buffer_capacity_(std::max(50, (int)(5 * compression)))
+{
+	if (!(compression>=10.0))
+	{
+		THROW(ArgumentException, "Quantile sketch compression must be at least 10, but is " + QString::number(compression) + "!");
+	}
+
+	clear();
+}
+
+void QuantileSketch::add(const QVector<double>& data)
+{
+	foreach(double value, data)
+	{
+		add(value);
+	}
+}
+
+void QuantileSketch::merge(const QuantileSketch& other)
+{
+	other.compress();
+	foreach(const Centroid& centroid, other.centroids_)
+	{
+		buffer_.append(centroid);
+	}
+	compress();
+
+	//centroids keep their means, so the exact extremes have to be merged separately
+	min_ = std::min(min_, other.min_);
+	max_ = std::max(max_, other.max_);
+}
+
+void QuantileSketch::clear()
+{
+	centroids_.clear();
+	buffer_.clear();
+	total_ = 0.0;
+	min_ = std::numeric_limits<double>::infinity();
+	max_ = -std::numeric_limits<double>::infinity();
+}
+
+double QuantileSketch::count() const
+{
+	compress();
+	return total_;
+}
+
+double QuantileSketch::min() const
+{
+	checkNotEmpty("minimum");
+	return min_;
+}
+
+double QuantileSketch::max() const
+{
+	checkNotEmpty("maximum");
+	return max_;
+}
+
+double QuantileSketch::quantile(double p) const
+{
+	checkNotEmpty("quantile");
+	if (!(p>=0.0 && p<=1.0))
+	{
+		THROW(StatisticsException, "Cannot calculate quantile for probability " + QString::number(p) + "!");
+	}
+
+	//interpolate between the centers of the centroids (the outer halves of the first and last centroid are interpolated towards the exact extremes)
+	const int n = centroids_.count();
+	const double target = p * total_;
+	const Centroid& first = centroids_[0];
+	if (target<=first.weight/2.0)
+	{
+		if (first.weight==1.0) return min_;
+		return min_ + target / (first.weight/2.0) * (first.mean - min_);
+	}
+
+	double cumulative = 0.0;
+	for (int i=0; i<n-1; ++i)
+	{
+		const Centroid& c = centroids_[i];
+		const Centroid& next = centroids_[i+1];
+		const double center = cumulative + c.weight/2.0;
+		const double next_center = cumulative + c.weight + next.weight/2.0;
+		if (target<=next_center)
+		{
+			return c.mean + (target - center) / (next_center - center) * (next.mean - c.mean);
+		}
+		cumulative += c.weight;
+	}
+
+	const Centroid& last = centroids_[n-1];
+	if (last.weight==1.0) return max_;
+	const double center = total_ - last.weight/2.0;
+	return std::min(max_, last.mean + (target - center) / (last.weight/2.0) * (max_ - last.mean));
+}
+
+double QuantileSketch::cdf(double value) const
+{
+	checkNotEmpty("cdf");
+	if (value<min_) return 0.0;
+	if (value>=max_) return 1.0;
+
+	//inverse of the interpolation in quantile()
+	const int n = centroids_.count();
+	const Centroid& first = centroids_[0];
+	if (value<first.mean)
+	{
+		return (value - min_) / (first.mean - min_) * (first.weight/2.0) / total_;
+	}
+
+	double cumulative = 0.0;
+	for (int i=0; i<n-1; ++i)
+	{
+		const Centroid& c = centroids_[i];
+		const Centroid& next = centroids_[i+1];
+		if (value<next.mean)
+		{
+			const double center = cumulative + c.weight/2.0;
+			const double next_center = cumulative + c.weight + next.weight/2.0;
+			return (center + (value - c.mean) / (next.mean - c.mean) * (next_center - center)) / total_;
+		}
+		cumulative += c.weight;
+	}
+
+	const Centroid& last = centroids_[n-1];
+	const double center = total_ - last.weight/2.0;
+	return (center + (value - last.mean) / (max_ - last.mean) * (last.weight/2.0)) / total_;
+}
+
+Histogram QuantileSketch::toHistogram(double min, double max, double bin_size) const
+{
+	Histogram output(min, max, bin_size);
+	if (count()==0.0) return output;
+
+	double previous = cdf(min);
+	for (int i=0; i<output.binCount(); ++i)
+	{
+		const double start = output.startOfBin(i);
+		const double current = cdf(std::min(start + bin_size, max));
+		output.incBy(start + bin_size/2.0, (current - previous) * total_, true);
+		previous = current;
+	}
+	return output;
+}
+
+int QuantileSketch::centroidCount() const
+{
+	compress();
+	return centroids_.count();
+}
+
+QByteArray QuantileSketch::toByteArray() const
+{
+	compress();
+
+	SketchHeader header;
+	std::copy(SKETCH_MAGIC, SKETCH_MAGIC + 8, header.magic);
+	header.version = SKETCH_VERSION;
+	header.byte_order = SKETCH_BYTE_ORDER;
+	header.compression = compression_;
+	header.total = total_;
+	header.min = min_;
+	header.max = max_;
+	header.centroid_count = centroids_.count();
+
+	QByteArray output;
+	output.reserve(sizeof(header) + centroids_.count() * sizeof(Centroid));
+	output.append(reinterpret_cast<const char*>(&header), sizeof(header));
+	output.append(reinterpret_cast<const char*>(centroids_.constData()), centroids_.count() * sizeof(Centroid));
+	return output;
+}
+
+QuantileSketch QuantileSketch::fromByteArray(const QByteArray& data)
+{
+	SketchHeader header;
+	if (data.size()<(int)sizeof(header))
+	{
+		THROW(FileParseException, "Quantile sketch data is truncated!");
+	}
+	std::copy(data.constData(), data.constData() + sizeof(header), reinterpret_cast<char*>(&header));
+	if (!std::equal(SKETCH_MAGIC, SKETCH_MAGIC + 8, header.magic))
+	{
+		THROW(FileParseException, "Data is not a quantile sketch!");
+	}
+	if (header.version!=SKETCH_VERSION)
+	{
+		THROW(FileParseException, "Quantile sketch has version " + QString::number(header.version) + ", but version " + QString::number(SKETCH_VERSION) + " is required!");
+	}
+	if (header.byte_order!=SKETCH_BYTE_ORDER)
+	{
+		THROW(FileParseException, "Quantile sketch was created on an incompatible platform!");
+	}
+	if (!(header.compression>0.0 && header.compression<=std::numeric_limits<double>::max()))
+	{
+		THROW(FileParseException, "Quantile sketch has invalid compression " + QString::number(header.compression) + "!");
+	}
+	if (header.centroid_count>(quint64)std::numeric_limits<int>::max() / sizeof(Centroid) || (quint64)data.size()!=sizeof(header) + header.centroid_count * sizeof(Centroid))
+	{
+		THROW(FileParseException, "Quantile sketch data is truncated!");
+	}
+
+	QuantileSketch output(header.compression);
+	output.total_ = header.total;
+	output.min_ = header.min;
+	output.max_ = header.max;
+	output.centroids_.resize((int)header.centroid_count);
+	const char* centroids = data.constData() + sizeof(header);
+	std::copy(centroids, centroids + header.centroid_count * sizeof(Centroid), reinterpret_cast<char*>(output.centroids_.data()));
+	return output;
+}
+
+void QuantileSketch::compress() const
+{
+	if (buffer_.isEmpty()) return;
+
+	foreach(const Centroid& centroid, buffer_)
+	{
+		total_ += centroid.weight;
+		min_ = std::min(min_, centroid.mean);
+		max_ = std::max(max_, centroid.mean);
+	}
+
+	//sort centroids and buffered values together
+	QVector<Centroid> input = centroids_;
+	input += buffer_;
+	buffer_.clear();
+	std::sort(input.begin(), input.end(), [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+
+	//merge neighbors as long as the merged centroid does not exceed the size limit of its quantile range
+	centroids_.clear();
+	Centroid current = input[0];
+	double weight_before = 0.0;
+	double q_limit = weightLimit(0.0, total_, compression_);
+	for (int i=1; i<input.count(); ++i)
+	{
+		const Centroid& next = input[i];
+		if (weight_before + current.weight + next.weight<=q_limit)
+		{
+			current.weight += next.weight;
+			current.mean += (next.mean - current.mean) * next.weight / current.weight;
+		}
+		else
+		{
+			centroids_.append(current);
+			weight_before += current.weight;
+			q_limit = weightLimit(weight_before, total_, compression_);
+			current = next;
+		}
+	}
+	centroids_.append(current);
+}
+
+void QuantileSketch::checkNotEmpty(QString statistic) const
+{
+	compress();
+	if (centroids_.isEmpty())
+	{
+		THROW(StatisticsException, "Cannot calculate " + statistic + " of empty quantile sketch!");
+	}
+}
@@ -0,0 +1,91 @@
+#ifndef QUANTILESKETCH_H
+#define QUANTILESKETCH_H
+
+#include "cppCORE_global.h"
+#include "Histogram.h"
+#include <QVector>
+#include <QByteArray>
+#include <limits>
+#include <math.h>
+
+/**
+  @brief Mergeable quantile sketch with bounded memory (merging t-digest).
+
+  The sketch summarizes a data stream of any length by at most about compression weighted centroids. Centroids are small in the tails and large near the median.
+  For the default compression of 100, the rank error of quantile(p) and cdf() is typically around 0.1-0.2% near the median and much lower for extreme quantiles.
+  Minimum and maximum are exact, and small data sets (fewer than about compression/4 values) are kept without merging.
+  Values are collected in a buffer and merged into the centroids in bulk. Sketches of threads or files can be combined with merge() and stored with toByteArray().
+  Queries merge the buffer, so a sketch that is queried from several threads concurrently must be protected by a mutex.
+*/
+class CPPCORESHARED_EXPORT QuantileSketch
+{
+public:
+	///Constructor. Larger @p compression values give more accurate quantiles, but need more memory (about 16 bytes per centroid plus a buffer of 5*compression values).
+	QuantileSketch(double compression=100.0);
+
+	///Adds a value with a weight (e.g. the number of positions with a given depth). Invalid values (NaN, infinity) are ignored.
+	void add(double value, double weight=1.0)
+	{
+		if (!(weight>0.0) || !(fabs(value)<=std::numeric_limits<double>::max())) return;
+
+		Centroid centroid = {value, weight};
+		buffer_.append(centroid);
+		if (buffer_.count()>=buffer_capacity_) compress();
+	}
+	///Adds all values of an array.
+	void add(const QVector<double>& data);
+	///Adds the data of another sketch.
+	void merge(const QuantileSketch& other);
+	///Resets the sketch to the empty state.
+	void clear();
+
+	///Returns the compression parameter.
+	double compression() const
+	{
+		return compression_;
+	}
+	///Returns the total weight of the added values, i.e. the number of values if all weights are 1.
+	double count() const;
+	///Returns the minimum.
+	double min() const;
+	///Returns the maximum.
+	double max() const;
+	///Returns the estimated @p p quantile (0<=p<=1).
+	double quantile(double p) const;
+	///Returns the estimated fraction of values smaller than or equal to @p value.
+	double cdf(double value) const;
+	///Returns a histogram of the estimated distribution. The estimated weight of each bin is added at the center of the bin.
+	Histogram toHistogram(double min, double max, double bin_size) const;
+	///Returns the number of centroids (for debugging and memory estimation).
+	int centroidCount() const;
+
+	///Returns a binary representation of the sketch.
+	QByteArray toByteArray() const;
+	///Creates a sketch from the binary representation returned by toByteArray(). Throws a FileParseException if the data is invalid.
+	static QuantileSketch fromByteArray(const QByteArray& data);
+
+protected:
+	///Weighted mean of a group of values.
+	struct Centroid
+	{
+		double mean;
+		double weight;
+	};
+
+	///Merges the buffer into the centroids.
+	void compress() const;
+	///Throws a StatisticsException if the sketch is empty.
+	void checkNotEmpty(QString statistic) const;
+
+	double compression_;
+	int buffer_capacity_;
+	///Centroids sorted by mean
+	mutable QVector<Centroid> centroids_;
+	///Values that were not merged into the centroids yet
+	mutable QVector<Centroid> buffer_;
+	mutable double total_;
+	mutable double min_;
+	mutable double max_;
+};
+
+#endif // QUANTILESKETCH_H
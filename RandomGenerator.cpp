@@ -0,0 +1,164 @@
+#include "RandomGenerator.h"
+#include "Exceptions.h"
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QCoreApplication>
+#include <math.h>
+
+namespace
+{
+	const quint64 SPLITMIX_INCREMENT = Q_UINT64_C(0x9E3779B97F4A7C15);
+	const double TWO_PI = 6.283185307179586;
+
+	//splitmix64 output function (a bijection with mix(0)==0)
+	quint64 mix(quint64 z)
+	{
+		z = (z ^ (z >> 30)) * Q_UINT64_C(0xBF58476D1CE4E5B9);
+		z = (z ^ (z >> 27)) * Q_UINT64_C(0x94D049BB133111EB);
+		return z ^ (z >> 31);
+	}
+
+	quint64 splitmix64(quint64& x)
+	{
+		x += SPLITMIX_INCREMENT;
+		return mix(x);
+	}
+}
+
+RandomGenerator::RandomGenerator(quint64 seed, quint64 stream)
+{
+	this->seed(seed, stream);
+}
+
+void RandomGenerator::seed(quint64 seed, quint64 stream)
+{
+	//the stream is hashed before it is combined with the seed, so there are no simple relations between (seed, stream) pairs with the same state (stream 0 is plain splitmix64 seeding)
+	quint64 x = seed ^ mix(stream);
+	for (int i=0; i<4; ++i)
+	{
+		s_[i] = splitmix64(x);
+	}
+	has_spare_normal_ = false;
+	spare_normal_ = 0.0;
+}
+
+void RandomGenerator::jump()
+{
+	static const quint64 JUMP[] = { Q_UINT64_C(0x180EC6D33CFD0ABA), Q_UINT64_C(0xD5A61266F0C9392C), Q_UINT64_C(0xA9582618E03FC9AA), Q_UINT64_C(0x39ABDC4529B1661C) };
+
+	quint64 s[4] = { 0, 0, 0, 0 };
+	for (int i=0; i<4; ++i)
+	{
+		for (int b=0; b<64; ++b)
+		{
+			if (JUMP[i] & (Q_UINT64_C(1) << b))
+			{
+				for (int j=0; j<4; ++j)
+				{
+					s[j] ^= s_[j];
+				}
+			}
+			next();
+		}
+	}
+	for (int j=0; j<4; ++j)
+	{
+		s_[j] = s[j];
+	}
+	has_spare_normal_ = false;
+}
+
+RandomGenerator& RandomGenerator::threadInstance()
+{
+	//the counter separates threads created in the same millisecond
+	static QAtomicInt counter(0);
+	thread_local RandomGenerator generator(QDateTime::currentMSecsSinceEpoch() ^ ((quint64)QCoreApplication::applicationPid() << 40), counter.fetchAndAddRelaxed(1));
+	return generator;
+}
+
+int RandomGenerator::integer(int min, int max)
+{
+	if (max<min)
+	{
+		THROW(ArgumentException, "Invalid integer range [" + QString::number(min) + ", " + QString::number(max) + "]!");
+	}
+
+	return (int)((qint64)min + (qint64)bounded((qint64)max - min + 1));
+}
+
+double RandomGenerator::normal(double mean, double stdev)
+{
+	if (has_spare_normal_)
+	{
+		has_spare_normal_ = false;
+		return mean + stdev * spare_normal_;
+	}
+
+	double value;
+	normalPair(value, spare_normal_);
+	has_spare_normal_ = true;
+	return mean + stdev * value;
+}
+
+void RandomGenerator::fillUniform(double* data, int n, double min, double max)
+{
+	for (int i=0; i<n; ++i)
+	{
+		data[i] = uniform(min, max);
+	}
+}
+
+void RandomGenerator::fillInteger(int* data, int n, int min, int max)
+{
+	if (max<min)
+	{
+		THROW(ArgumentException, "Invalid integer range [" + QString::number(min) + ", " + QString::number(max) + "]!");
+	}
+
+	const quint64 range = (qint64)max - min + 1;
+	for (int i=0; i<n; ++i)
+	{
+		data[i] = (int)((qint64)min + (qint64)bounded(range));
+	}
+}
+
+void RandomGenerator::fillNormal(double* data, int n, double mean, double stdev)
+{
+	int i = 0;
+	for (; i+1<n; i+=2)
+	{
+		double a, b;
+		normalPair(a, b);
+		data[i] = mean + stdev * a;
+		data[i+1] = mean + stdev * b;
+	}
+	if (i<n)
+	{
+		data[i] = normal(mean, stdev);
+	}
+}
+
+quint64 RandomGenerator::bounded(quint64 range)
+{
+	quint64 product = (next() >> 32) * range;
+	quint64 low = product & Q_UINT64_C(0xFFFFFFFF);
+	if (low<range)
+	{
+		//reject the values that would make the result biased
+		const quint64 threshold = ((Q_UINT64_C(1) << 32) - range) % range;
+		while (low<threshold)
+		{
+			product = (next() >> 32) * range;
+			low = product & Q_UINT64_C(0xFFFFFFFF);
+		}
+	}
+	return product >> 32;
+}
+
+void RandomGenerator::normalPair(double& a, double& b)
+{
+	const double radius = sqrt(-2.0 * log(1.0 - uniform()));
+	const double angle = TWO_PI * uniform();
+	a = radius * cos(angle);
+	b = radius * sin(angle);
+}
@@ -0,0 +1,78 @@
+#ifndef RANDOMGENERATOR_H
+#define RANDOMGENERATOR_H
+
+#include "cppCORE_global.h"
+#include <QtGlobal>
+
+/**
+  @brief Fast pseudo-random number generator (xoshiro256**) with explicit seeding and independent streams.
+
+  The state is initialized with splitmix64 from the seed combined with a hash of the stream. Thus, all (seed, stream) pairs start at unrelated states,
+  and overlapping sequences are as unlikely as for random seeds. Use jump() if sequences must not overlap for certain.
+  For reproducible parallel runs, create one generator per work item with the same seed and the work item index as stream (not one per thread, because the assignment of items to threads varies).
+  A generator instance is not thread-safe. Use threadInstance() for a generator private to the calling thread.
+*/
+class CPPCORESHARED_EXPORT RandomGenerator
+{
+public:
+	///Constructor.
+	RandomGenerator(quint64 seed, quint64 stream=0);
+	///Re-initializes the generator.
+	void seed(quint64 seed, quint64 stream=0);
+	///Advances the generator by 2^128 values, which is equivalent to 2^128 calls of next().
+	void jump();
+
+	///Returns the generator of the calling thread. It is seeded from time, process and thread unless seeded explicitly.
+	static RandomGenerator& threadInstance();
+
+	///Returns the next 64 random bits.
+	quint64 next()
+	{
+		const quint64 result = rotate(s_[1] * 5, 7) * 9;
+		const quint64 t = s_[1] << 17;
+		s_[2] ^= s_[0];
+		s_[3] ^= s_[1];
+		s_[1] ^= s_[2];
+		s_[0] ^= s_[3];
+		s_[2] ^= t;
+		s_[3] = rotate(s_[3], 45);
+		return result;
+	}
+	///Returns a uniformly distributed number in [0, 1).
+	double uniform()
+	{
+		return (next() >> 11) * (1.0 / 9007199254740992.0);
+	}
+	///Returns a uniformly distributed number in [min, max).
+	double uniform(double min, double max)
+	{
+		return min + uniform() * (max - min);
+	}
+	///Returns a uniformly distributed integer in [min, max], without modulo bias.
+	int integer(int min, int max);
+	///Returns a normally distributed number.
+	double normal(double mean=0.0, double stdev=1.0);
+
+	///Fills @p data with uniformly distributed numbers in [min, max).
+	void fillUniform(double* data, int n, double min=0.0, double max=1.0);
+	///Fills @p data with uniformly distributed integers in [min, max].
+	void fillInteger(int* data, int n, int min, int max);
+	///Fills @p data with normally distributed numbers.
+	void fillNormal(double* data, int n, double mean=0.0, double stdev=1.0);
+
+protected:
+	quint64 s_[4];
+	double spare_normal_;
+	bool has_spare_normal_;
+
+	static quint64 rotate(quint64 x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+	///Returns a uniformly distributed integer in [0, range) for 0<range<=2^32 (Lemire's multiply-shift method).
+	quint64 bounded(quint64 range);
+	///Writes two independent standard normal numbers (Box-Muller transformation).
+	void normalPair(double& a, double& b);
+};
+
+#endif // RANDOMGENERATOR_H
@@ -0,0 +1,224 @@
+#ifndef RANGESTATISTICS_H
+#define RANGESTATISTICS_H
+
+#include "cppCORE_global.h"
+#include "Exceptions.h"
+#include <QPair>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include <cmath>
+
+/**
+  @brief Statistics on contiguous arrays given as pointer and length, for any floating-point or integer value type.
+
+  The functions work on QVector::constData(), std::vector::data(), memory-mapped files or sub-ranges without copying the data into a QVector<double>.
+  The accumulator type @p Acc is selected at compile time and defaults to double, e.g. mean<float>(data, n) sums float data in single precision,
+  while mean(data, n) reads float data but sums in double precision. Use long double for extra precision.
+  The semantics are the same as in BasicStatistics: variance and standard deviation are population statistics, and invalid values (NaN, infinity) are only ignored by getMinMax().
+*/
+class RangeStatistics
+{
+public:
+	///Calculates the sum of the data.
+	template <typename Acc=double, typename T>
+	static Acc sum(const T* data, qint64 n)
+	{
+		//four independent partial sums allow the compiler to vectorize the loop
+		Acc s0 = Acc(0);
+		Acc s1 = Acc(0);
+		Acc s2 = Acc(0);
+		Acc s3 = Acc(0);
+		qint64 i = 0;
+		for (; i+4<=n; i+=4)
+		{
+			s0 += static_cast<Acc>(data[i]);
+			s1 += static_cast<Acc>(data[i+1]);
+			s2 += static_cast<Acc>(data[i+2]);
+			s3 += static_cast<Acc>(data[i+3]);
+		}
+		for (; i<n; ++i)
+		{
+			s0 += static_cast<Acc>(data[i]);
+		}
+		return (s0 + s1) + (s2 + s3);
+	}
+
+	///Calculates the mean of the data.
+	template <typename Acc=double, typename T>
+	static Acc mean(const T* data, qint64 n)
+	{
+		if (n==0)
+		{
+			THROW(StatisticsException, "Cannot calculate mean on empty data array.");
+		}
+
+		return sum<Acc>(data, n) / static_cast<Acc>(n);
+	}
+
+	///Calculates the variance of the data, using a given mean.
+	template <typename Acc=double, typename T>
+	static Acc variance(const T* data, qint64 n, Acc mean)
+	{
+		if (n==0)
+		{
+			THROW(StatisticsException, "Cannot calculate variance on empty data array.");
+		}
+
+		Acc s0 = Acc(0);
+		Acc s1 = Acc(0);
+		qint64 i = 0;
+		for (; i+2<=n; i+=2)
+		{
+			const Acc d0 = static_cast<Acc>(data[i]) - mean;
+			const Acc d1 = static_cast<Acc>(data[i+1]) - mean;
+			s0 += d0 * d0;
+			s1 += d1 * d1;
+		}
+		for (; i<n; ++i)
+		{
+			const Acc d = static_cast<Acc>(data[i]) - mean;
+			s0 += d * d;
+		}
+		return (s0 + s1) / static_cast<Acc>(n);
+	}
+
+	///Calculates the variance of the data.
+	template <typename Acc=double, typename T>
+	static Acc variance(const T* data, qint64 n)
+	{
+		return variance<Acc>(data, n, mean<Acc>(data, n));
+	}
+
+	///Calculates the standard deviation of the data.
+	template <typename Acc=double, typename T>
+	static Acc stdev(const T* data, qint64 n)
+	{
+		if (n==0)
+		{
+			THROW(StatisticsException, "Cannot calculate standard deviation on empty data array.");
+		}
+
+		return std::sqrt(variance<Acc>(data, n));
+	}
+
+	///Calculates the correlation of two data arrays of length @p n.
+	template <typename Acc=double, typename T>
+	static Acc correlation(const T* x, const T* y, qint64 n)
+	{
+		if (n==0)
+		{
+			THROW(StatisticsException, "Cannot calculate correlation of data arrays with zero length!");
+		}
+
+		const Acc x_mean = mean<Acc>(x, n);
+		const Acc y_mean = mean<Acc>(y, n);
+		Acc sxx = Acc(0);
+		Acc syy = Acc(0);
+		Acc sxy = Acc(0);
+		for (qint64 i=0; i<n; ++i)
+		{
+			const Acc dx = static_cast<Acc>(x[i]) - x_mean;
+			const Acc dy = static_cast<Acc>(y[i]) - y_mean;
+			sxx += dx * dx;
+			syy += dy * dy;
+			sxy += dx * dy;
+		}
+		return sxy / std::sqrt(sxx) / std::sqrt(syy);
+	}
+
+	///Returns minimum and maximum of the data. Ignores invalid values. If there is no valid value, the largest value of the type is returned as minimum and the lowest as maximum.
+	template <typename T>
+	static QPair<T, T> getMinMax(const T* data, qint64 n)
+	{
+		T min = std::numeric_limits<T>::max();
+		T max = std::numeric_limits<T>::lowest();
+		for (qint64 i=0; i<n; ++i)
+		{
+			if (!isValid(data[i])) continue;
+
+			min = std::min(min, data[i]);
+			max = std::max(max, data[i]);
+		}
+		return qMakePair(min, max);
+	}
+
+	///Floating-point type of interpolated results (median, quantile): @p Acc, or double if @p Acc is an integer type.
+	template <typename Acc>
+	struct Interpolated
+	{
+		typedef typename std::conditional<std::is_floating_point<Acc>::value, Acc, double>::type Type;
+	};
+
+	///Calculates the median from sorted data. For an even number of values, the mean of the two middle values is returned (as double if @p Acc is an integer type).
+	template <typename Acc=double, typename T>
+	static typename Interpolated<Acc>::Type median(const T* data, qint64 n)
+	{
+		typedef typename Interpolated<Acc>::Type Real;
+
+		if (n==0)
+		{
+			THROW(StatisticsException, "Cannot calculate median on empty data array!");
+		}
+
+		if (n%2==0)
+		{
+			return Real(0.5) * (static_cast<Real>(data[n/2]) + static_cast<Real>(data[n/2-1]));
+		}
+		return static_cast<Real>(data[n/2]);
+	}
+
+	///Calculates the @p p quantile (0<=p<=1) of unsorted data in expected linear time, see BasicStatistics::quantile(). The data is copied, not modified.
+	///The interpolation between neighboring values is done in floating point (double if @p Acc is an integer type).
+	template <typename Acc=double, typename T>
+	static typename Interpolated<Acc>::Type quantile(const T* data, qint64 n, double p)
+	{
+		typedef typename Interpolated<Acc>::Type Real;
+
+		if (n==0)
+		{
+			THROW(StatisticsException, "Cannot calculate quantile on empty data array!");
+		}
+		if (!(p>=0.0 && p<=1.0))
+		{
+			THROW(StatisticsException, "Cannot calculate quantile for probability " + QString::number(p) + "!");
+		}
+
+		std::vector<T> tmp(data, data + n);
+		const double position = p * (n-1);
+		const qint64 lower = std::min((qint64)position, n-1);
+		std::nth_element(tmp.begin(), tmp.begin() + lower, tmp.end());
+		const Real lower_value = static_cast<Real>(tmp[lower]);
+		if (lower==n-1) return lower_value;
+
+		const Real upper_value = static_cast<Real>(*std::min_element(tmp.begin() + lower + 1, tmp.end()));
+		return lower_value + static_cast<Real>(position - lower) * (upper_value - lower_value);
+	}
+
+	///Returns if the data is sorted.
+	template <typename T>
+	static bool isSorted(const T* data, qint64 n)
+	{
+		for (qint64 i=1; i<n; ++i)
+		{
+			if (data[i-1]>data[i]) return false;
+		}
+		return true;
+	}
+
+	///Returns if a value is valid, i.e. not NaN or infinite. Integer values are always valid.
+	template <typename T>
+	static bool isValid(T value)
+	{
+		if (!std::is_floating_point<T>::value) return true;
+
+		return value==value && value<=std::numeric_limits<T>::max() && value>=std::numeric_limits<T>::lowest();
+	}
+
+protected:
+	///Constructor declared away.
+	RangeStatistics();
+};
+
+#endif // RANGESTATISTICS_H
@@ -0,0 +1,107 @@
+#include "Resampling.h"
+#include "BasicStatistics.h"
+#include "StatisticsKernels.h"
+#include <math.h>
+
+QPair<double, double> Resampling::percentileInterval(QVector<double> replicates, double confidence)
+{
+	if (!(confidence>0.0 && confidence<1.0))
+	{
+		THROW(ArgumentException, "Confidence level must be in (0, 1), but is " + QString::number(confidence) + "!");
+	}
+
+	QVector<double> probabilities;
+	probabilities << (1.0 - confidence) / 2.0 << (1.0 + confidence) / 2.0;
+	QVector<double> bounds = BasicStatistics::quantilesInPlace(replicates, probabilities);
+	return qMakePair(bounds[0], bounds[1]);
+}
+
+QPair<double, double> Resampling::meanConfidenceInterval(const QVector<double>& data, double confidence, int replicates, quint64 seed, int threads)
+{
+	const double* values = data.constData();
+	QVector<double> means = bootstrap(data.count(), replicates, [values](const int* indices, int n)
+	{
+		double sum = 0.0;
+		for (int i=0; i<n; ++i)
+		{
+			sum += values[indices[i]];
+		}
+		return sum / n;
+	}, seed, threads);
+
+	return percentileInterval(means, confidence);
+}
+
+PermutationTestResult Resampling::correlationTest(const QVector<double>& x, const QVector<double>& y, int max_permutations, quint64 seed, Alternative alternative, int max_hits, int threads)
+{
+	const int n = x.count();
+	if (y.count()!=n)
+	{
+		THROW(StatisticsException, "Cannot calculate correlation of data arrays with different length!");
+	}
+	if (n==0)
+	{
+		THROW(StatisticsException, "Cannot calculate correlation of data arrays with zero length!");
+	}
+
+	//standardize both arrays once (mean 0, sum of squares 1), so that the correlation of a permutation is a dot product
+	QVector<double> zx(n);
+	QVector<double> zy(n);
+	for (int a=0; a<2; ++a)
+	{
+		const QVector<double>& data = a==0 ? x : y;
+		QVector<double>& output = a==0 ? zx : zy;
+		const double mean = StatisticsKernels::sum(data.constData(), n) / n;
+		const double sum_of_squares = StatisticsKernels::sumSquaredDeviations(data.constData(), n, mean);
+		if (!(sum_of_squares>0.0))
+		{
+			THROW(StatisticsException, "Cannot perform correlation test of data without variance!");
+		}
+		const double factor = 1.0 / sqrt(sum_of_squares);
+		for (int i=0; i<n; ++i)
+		{
+			output[i] = (data[i] - mean) * factor;
+		}
+	}
+
+	const double* px = zx.constData();
+	const double* py = zy.constData();
+	return permutationTest(n, [px, py](const int* permutation, int n)
+	{
+		double sum = 0.0;
+		for (int i=0; i<n; ++i)
+		{
+			sum += px[i] * py[permutation[i]];
+		}
+		return sum;
+	}, max_permutations, seed, alternative, max_hits, threads);
+}
+
+void Resampling::checkArguments(int n, int replicates)
+{
+	if (n<1)
+	{
+		THROW(ArgumentException, "Cannot resample data with " + QString::number(n) + " elements!");
+	}
+	if (replicates<1)
+	{
+		THROW(ArgumentException, "Number of replicates must be positive, but is " + QString::number(replicates) + "!");
+	}
+}
+
+void Resampling::shuffle(int* data, int n, RandomGenerator& generator)
+{
+	for (int i=n-1; i>0; --i)
+	{
+		std::swap(data[i], data[generator.integer(0, i)]);
+	}
+}
+
+bool Resampling::isHit(double value, double observed, Alternative alternative)
+{
+	//the tolerance makes sure that permutations with the same statistic as observed are counted despite rounding errors
+	const double tolerance = 1e-12 * std::max(1.0, fabs(observed));
+	if (alternative==GREATER) return value >= observed - tolerance;
+	if (alternative==LESS) return value <= observed + tolerance;
+	return fabs(value) >= fabs(observed) - tolerance;
+}
@@ -0,0 +1,183 @@
+#ifndef RESAMPLING_H
+#define RESAMPLING_H
+
+#include "cppCORE_global.h"
+#include "Exceptions.h"
+#include "Parallel.h"
+#include "RandomGenerator.h"
+#include <QVector>
+#include <QPair>
+#include <algorithm>
+#include <vector>
+
+///Result of a permutation test.
+struct CPPCORESHARED_EXPORT PermutationTestResult
+{
+	double observed; ///< statistic of the original data
+	double p_value; ///< empirical p-value
+	int permutations; ///< number of permutations performed
+	int hits; ///< number of permutations with a statistic at least as extreme as the observed statistic
+	bool stopped_early; ///< true if the test was stopped because the hit limit was reached
+};
+
+/**
+  @brief Parallel bootstrap and permutation resampling of a user-defined statistic.
+
+  The statistic is a functor with the signature 'double statistic(const int* indices, int n)' that calculates the statistic of the data elements selected by the indices.
+  For the bootstrap, the indices are drawn with replacement. For permutation tests, they are a random permutation of [0, n).
+  Replicates are processed in blocks of BLOCK_SIZE on a thread pool (see Parallel). Each block uses its own RandomGenerator stream of @p seed,
+  so the results are reproducible and do not depend on the number of threads. Non-positive @p threads values mean 'all cores'.
+  The statistic functor is copied for each worker, so it can keep mutable scratch buffers. The index buffers are allocated once per worker.
+*/
+class CPPCORESHARED_EXPORT Resampling
+{
+public:
+	///Alternative hypothesis of a permutation test.
+	enum Alternative
+	{
+		TWO_SIDED, ///< absolute value of the statistic is at least as large as observed (for statistics centered on 0 like correlations)
+		GREATER, ///< statistic is at least as large as observed
+		LESS ///< statistic is at most as large as observed
+	};
+
+	///Default number of hits after which permutation tests are stopped.
+	static const int DEFAULT_MAX_HITS = 100;
+
+	///Returns the statistic of @p replicates bootstrap samples of @p n elements, in replicate order.
+	template <typename Statistic>
+	static QVector<double> bootstrap(int n, int replicates, Statistic statistic, quint64 seed=0, int threads=0);
+
+	/**
+	  @brief Performs a permutation test with up to @p max_permutations permutations.
+
+	  With sequential stopping (Besag and Clifford, 1991), the test stops as soon as @p max_hits permutations were at least as extreme as the observed statistic.
+	  The p-value is then hits/permutations. Otherwise, it is (hits+1)/(permutations+1). Use a non-positive @p max_hits to disable stopping.
+	  Stopping is checked after each block of permutations, in block order.
+	*/
+	template <typename Statistic>
+	static PermutationTestResult permutationTest(int n, Statistic statistic, int max_permutations, quint64 seed=0, Alternative alternative=TWO_SIDED, int max_hits=DEFAULT_MAX_HITS, int threads=0);
+
+	///Returns the percentile confidence interval of bootstrap replicates (quantiles (1-confidence)/2 and (1+confidence)/2).
+	static QPair<double, double> percentileInterval(QVector<double> replicates, double confidence=0.95);
+	///Returns the bootstrap percentile confidence interval of the mean.
+	static QPair<double, double> meanConfidenceInterval(const QVector<double>& data, double confidence=0.95, int replicates=10000, quint64 seed=0, int threads=0);
+	///Performs a permutation test of the Pearson correlation of two data arrays.
+	static PermutationTestResult correlationTest(const QVector<double>& x, const QVector<double>& y, int max_permutations=100000, quint64 seed=0, Alternative alternative=TWO_SIDED, int max_hits=DEFAULT_MAX_HITS, int threads=0);
+
+protected:
+	///Constructor declared away.
+	Resampling();
+
+	///Number of replicates per block, i.e. per random number stream.
+	static const int BLOCK_SIZE = 256;
+
+	///Checks the arguments of bootstrap() and permutationTest().
+	static void checkArguments(int n, int replicates);
+	///Randomly shuffles the data (Fisher-Yates).
+	static void shuffle(int* data, int n, RandomGenerator& generator);
+	///Returns if @p value is at least as extreme as @p observed.
+	static bool isHit(double value, double observed, Alternative alternative);
+};
+
+template <typename Statistic>
+QVector<double> Resampling::bootstrap(int n, int replicates, Statistic statistic, quint64 seed, int threads)
+{
+	checkArguments(n, replicates);
+
+	const int blocks = (replicates + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	const int workers = Parallel::threadCount(blocks, threads);
+	std::vector<Statistic> statistics(workers, statistic);
+	QVector<QVector<int> > buffers(workers);
+	for (int w=0; w<workers; ++w)
+	{
+		buffers[w].resize(n);
+	}
+	QVector<int>* indices = buffers.data();
+	QVector<double> output(replicates);
+	double* values = output.data();
+
+	Parallel::forEach(blocks, [&statistics, indices, values, n, replicates, seed](int block, int worker)
+	{
+		RandomGenerator generator(seed, block);
+		int* sample = indices[worker].data();
+		const int end = std::min(replicates, (block + 1) * BLOCK_SIZE);
+		for (int r=block*BLOCK_SIZE; r<end; ++r)
+		{
+			generator.fillInteger(sample, n, 0, n - 1);
+			values[r] = statistics[worker](sample, n);
+		}
+	}, threads);
+
+	return output;
+}
+
+template <typename Statistic>
+PermutationTestResult Resampling::permutationTest(int n, Statistic statistic, int max_permutations, quint64 seed, Alternative alternative, int max_hits, int threads)
+{
+	checkArguments(n, max_permutations);
+
+	PermutationTestResult result;
+	QVector<int> identity(n);
+	for (int i=0; i<n; ++i)
+	{
+		identity[i] = i;
+	}
+	result.observed = statistic(identity.constData(), n);
+	result.permutations = 0;
+	result.hits = 0;
+	result.stopped_early = false;
+
+	const int blocks = (max_permutations + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	const int workers = Parallel::threadCount(blocks, threads);
+	std::vector<Statistic> statistics(workers, statistic);
+	QVector<QVector<int> > buffers(workers);
+	for (int w=0; w<workers; ++w)
+	{
+		buffers[w].resize(n);
+	}
+	QVector<int>* indices = buffers.data();
+	QVector<int> block_hits(blocks, 0);
+	int* hits = block_hits.data();
+	const double observed = result.observed;
+
+	//process a few blocks per worker in each round, then check if the hit limit is reached
+	const int round_size = 4 * workers;
+	for (int first=0; first<blocks && !result.stopped_early; first+=round_size)
+	{
+		const int last = std::min(blocks, first + round_size);
+		Parallel::forEach(last - first, [&statistics, indices, hits, n, first, max_permutations, seed, observed, alternative](int i, int worker)
+		{
+			const int block = first + i;
+			RandomGenerator generator(seed, block);
+			int* permutation = indices[worker].data();
+			for (int j=0; j<n; ++j)
+			{
+				permutation[j] = j;
+			}
+
+			const int end = std::min(max_permutations, (block + 1) * BLOCK_SIZE);
+			for (int r=block*BLOCK_SIZE; r<end; ++r)
+			{
+				shuffle(permutation, n, generator);
+				if (isHit(statistics[worker](permutation, n), observed, alternative)) ++hits[block];
+			}
+		}, threads);
+
+		//combine the blocks in order, so that the result does not depend on the number of threads
+		for (int block=first; block<last; ++block)
+		{
+			result.hits += hits[block];
+			result.permutations = std::min(max_permutations, (block + 1) * BLOCK_SIZE);
+			if (max_hits>0 && result.hits>=max_hits)
+			{
+				result.stopped_early = true;
+				break;
+			}
+		}
+	}
+
+	result.p_value = result.stopped_early ? (double)result.hits / result.permutations : (result.hits + 1.0) / (result.permutations + 1.0);
+	return result;
+}
+
+#endif // RESAMPLING_H
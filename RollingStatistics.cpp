@@ -0,0 +1,232 @@
+#include "RollingStatistics.h"
+#include "Exceptions.h"
+#include <algorithm>
+#include <math.h>
+
+namespace
+{
+	///Fenwick tree that counts the value ranks in the current window and finds the k-th smallest rank in O(log n).
+	class RankCounter
+	{
+	public:
+		RankCounter(int n)
+			: tree_(n + 1, 0)
+			, top_bit_(1)
+		{
+			while (top_bit_*2<=n) top_bit_ *= 2;
+		}
+
+		void update(int rank, int delta)
+		{
+			for (int i=rank+1; i<tree_.count(); i+=i&(-i))
+			{
+				tree_[i] += delta;
+			}
+		}
+
+		///Returns the k-th smallest rank (0-based) in the window.
+		int find(int k) const
+		{
+			int pos = 0;
+			for (int bit=top_bit_; bit>0; bit/=2)
+			{
+				const int next = pos + bit;
+				if (next<tree_.count() && tree_[next]<=k)
+				{
+					pos = next;
+					k -= tree_[next];
+				}
+			}
+			return pos;
+		}
+
+	protected:
+		QVector<int> tree_;
+		int top_bit_;
+	};
+}
+
+QVector<double> RollingStatistics::mean(const QVector<double>& values, int window)
+{
+	QVector<int> begin, end;
+	fixedWindows(values.count(), window, begin, end);
+	return movingMoments(values, begin, end, false);
+}
+
+QVector<double> RollingStatistics::stdev(const QVector<double>& values, int window)
+{
+	QVector<int> begin, end;
+	fixedWindows(values.count(), window, begin, end);
+	return movingMoments(values, begin, end, true);
+}
+
+QVector<double> RollingStatistics::median(const QVector<double>& values, int window)
+{
+	return quantile(values, window, 0.5);
+}
+
+QVector<double> RollingStatistics::quantile(const QVector<double>& values, int window, double p)
+{
+	QVector<int> begin, end;
+	fixedWindows(values.count(), window, begin, end);
+	return movingQuantile(values, begin, end, p);
+}
+
+QVector<double> RollingStatistics::mean(const QVector<int>& positions, const QVector<double>& values, int radius)
+{
+	QVector<int> begin, end;
+	positionWindows(positions, values.count(), radius, begin, end);
+	return movingMoments(values, begin, end, false);
+}
+
+QVector<double> RollingStatistics::stdev(const QVector<int>& positions, const QVector<double>& values, int radius)
+{
+	QVector<int> begin, end;
+	positionWindows(positions, values.count(), radius, begin, end);
+	return movingMoments(values, begin, end, true);
+}
+
+QVector<double> RollingStatistics::median(const QVector<int>& positions, const QVector<double>& values, int radius)
+{
+	return quantile(positions, values, radius, 0.5);
+}
+
+QVector<double> RollingStatistics::quantile(const QVector<int>& positions, const QVector<double>& values, int radius, double p)
+{
+	QVector<int> begin, end;
+	positionWindows(positions, values.count(), radius, begin, end);
+	return movingQuantile(values, begin, end, p);
+}
+
+void RollingStatistics::fixedWindows(int n, int window, QVector<int>& begin, QVector<int>& end)
+{
+	if (window<1)
+	{
+		THROW(ArgumentException, "Window size must be positive, but is " + QString::number(window) + "!");
+	}
+
+	begin.resize(n);
+	end.resize(n);
+	for (int i=0; i<n; ++i)
+	{
+		begin[i] = std::max(0, i - window/2);
+		end[i] = std::min(n, i - window/2 + window);
+	}
+}
+
+void RollingStatistics::positionWindows(const QVector<int>& positions, int count, int radius, QVector<int>& begin, QVector<int>& end)
+{
+	if (positions.count()!=count)
+	{
+		THROW(ArgumentException, "Position and value arrays have different length!");
+	}
+	if (radius<0)
+	{
+		THROW(ArgumentException, "Window radius must not be negative, but is " + QString::number(radius) + "!");
+	}
+
+	const int n = positions.count();
+	begin.resize(n);
+	end.resize(n);
+	int b = 0;
+	int e = 0;
+	for (int i=0; i<n; ++i)
+	{
+		if (i>0 && positions[i]<positions[i-1])
+		{
+			THROW(ArgumentException, "Positions are not sorted: " + QString::number(positions[i]) + " after " + QString::number(positions[i-1]) + "!");
+		}
+
+		//64-bit arithmetic avoids overflows near the integer limits
+		while ((qint64)positions[b] < (qint64)positions[i] - radius) ++b;
+		if (e<=i) e = i + 1;
+		while (e<n && (qint64)positions[e] <= (qint64)positions[i] + radius) ++e;
+		begin[i] = b;
+		end[i] = e;
+	}
+}
+
+QVector<double> RollingStatistics::movingMoments(const QVector<double>& values, const QVector<int>& begin, const QVector<int>& end, bool stdev)
+{
+	const int n = values.count();
+	QVector<double> output(n);
+
+	//Welford updates for adding and removing values
+	int b = 0;
+	int e = 0;
+	double count = 0.0;
+	double mean = 0.0;
+	double m2 = 0.0;
+	for (int i=0; i<n; ++i)
+	{
+		while (e<end[i])
+		{
+			const double value = values[e++];
+			count += 1.0;
+			const double delta = value - mean;
+			mean += delta / count;
+			m2 += delta * (value - mean);
+		}
+		while (b<begin[i])
+		{
+			const double value = values[b++];
+			count -= 1.0;
+			if (count==0.0)
+			{
+				mean = 0.0;
+				m2 = 0.0;
+				continue;
+			}
+			const double delta = value - mean;
+			mean -= delta / count;
+			m2 -= delta * (value - mean);
+		}
+
+		output[i] = stdev ? sqrt(std::max(0.0, m2) / count) : mean;
+	}
+	return output;
+}
+
+QVector<double> RollingStatistics::movingQuantile(const QVector<double>& values, const QVector<int>& begin, const QVector<int>& end, double p)
+{
+	if (!(p>=0.0 && p<=1.0))
+	{
+		THROW(StatisticsException, "Cannot calculate quantile for probability " + QString::number(p) + "!");
+	}
+
+	//rank the values (ties get different ranks, which does not change the order statistics)
+	const int n = values.count();
+	QVector<int> order(n);
+	for (int i=0; i<n; ++i)
+	{
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [&values](int a, int b) { return values[a] < values[b]; });
+	QVector<int> rank(n);
+	for (int r=0; r<n; ++r)
+	{
+		rank[order[r]] = r;
+	}
+
+	//slide over the windows
+	QVector<double> output(n);
+	RankCounter counter(n);
+	int b = 0;
+	int e = 0;
+	for (int i=0; i<n; ++i)
+	{
+		while (e<end[i]) counter.update(rank[e++], 1);
+		while (b<begin[i]) counter.update(rank[b++], -1);
+
+		const double position = p * (e - b - 1);
+		const int lower = (int)position;
+		const double lower_value = values[order[counter.find(lower)]];
+		output[i] = lower_value;
+		if (position>lower)
+		{
+			const double upper_value = values[order[counter.find(lower + 1)]];
+			output[i] += (position - lower) * (upper_value - lower_value);
+		}
+	}
+	return output;
+}
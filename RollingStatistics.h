@@ -0,0 +1,52 @@
+#ifndef ROLLINGSTATISTICS_H
+#define ROLLINGSTATISTICS_H
+
+#include "cppCORE_global.h"
+#include <QVector>
+
+/**
+  @brief Moving-window statistics along ordered tracks, e.g. for coverage smoothing.
+
+  Each function returns one value per element, calculated from the window around the element:
+  - Fixed windows contain @p window elements centered on the element (the first window/2 elements before and the rest after it). Windows are truncated at the ends of the track.
+  - Position windows contain all elements whose position differs by at most @p radius from the position of the element. The positions must be sorted.
+  The windows are updated incrementally while sliding along the track: mean and standard deviation take amortized O(1) per element (Welford updates),
+  median and quantiles take O(log n) per element (order statistics of the window in a Fenwick tree over the value ranks).
+  Standard deviations are population statistics and quantiles are interpolated like in BasicStatistics::quantile(), so the results match BasicStatistics applied to each window.
+*/
+class CPPCORESHARED_EXPORT RollingStatistics
+{
+public:
+	///Returns the moving mean for fixed windows.
+	static QVector<double> mean(const QVector<double>& values, int window);
+	///Returns the moving standard deviation for fixed windows.
+	static QVector<double> stdev(const QVector<double>& values, int window);
+	///Returns the moving median for fixed windows.
+	static QVector<double> median(const QVector<double>& values, int window);
+	///Returns the moving @p p quantile (0<=p<=1) for fixed windows.
+	static QVector<double> quantile(const QVector<double>& values, int window, double p);
+
+	///Returns the moving mean for position windows.
+	static QVector<double> mean(const QVector<int>& positions, const QVector<double>& values, int radius);
+	///Returns the moving standard deviation for position windows.
+	static QVector<double> stdev(const QVector<int>& positions, const QVector<double>& values, int radius);
+	///Returns the moving median for position windows.
+	static QVector<double> median(const QVector<int>& positions, const QVector<double>& values, int radius);
+	///Returns the moving @p p quantile (0<=p<=1) for position windows.
+	static QVector<double> quantile(const QVector<int>& positions, const QVector<double>& values, int radius, double p);
+
+protected:
+	///Constructor declared away.
+	RollingStatistics();
+
+	///Calculates the window [begin, end) of each element for fixed windows.
+	static void fixedWindows(int n, int window, QVector<int>& begin, QVector<int>& end);
+	///Calculates the window [begin, end) of each element for position windows.
+	static void positionWindows(const QVector<int>& positions, int count, int radius, QVector<int>& begin, QVector<int>& end);
+	///Slides over the windows and calculates mean or standard deviation. Window bounds must be non-decreasing.
+	static QVector<double> movingMoments(const QVector<double>& values, const QVector<int>& begin, const QVector<int>& end, bool stdev);
+	///Slides over the windows and calculates the @p p quantile. Window bounds must be non-decreasing.
+	static QVector<double> movingQuantile(const QVector<double>& values, const QVector<int>& begin, const QVector<int>& end, double p);
+};
+
+#endif // ROLLINGSTATISTICS_H
@@ -0,0 +1,198 @@
+#include "StatisticsAccumulator.h"
+#include "Exceptions.h"
+#include <limits>
+#include <math.h>
+
+StatisticsAccumulator::StatisticsAccumulator()
+{
+	clear();
+}
+
+void StatisticsAccumulator::add(const QVector<double>& data)
+{
+	foreach(double value, data)
+	{
+		add(value);
+	}
+}
+
+void StatisticsAccumulator::merge(const StatisticsAccumulator& other)
+{
+	if (other.count_==0) return;
+	if (count_==0)
+	{
+		*this = other;
+		return;
+	}
+
+	const double n_a = count_;
+	const double n_b = other.count_;
+	const double n = n_a + n_b;
+	const double delta = other.mean_ - mean_;
+
+	m3_ += other.m3_ + delta * delta * delta * n_a * n_b * (n_a - n_b) / (n * n) + 3.0 * delta * (n_a * other.m2_ - n_b * m2_) / n;
+	m2_ += other.m2_ + delta * delta * n_a * n_b / n;
+	mean_ += delta * n_b / n;
+	count_ += other.count_;
+	if (other.min_<min_) min_ = other.min_;
+	if (other.max_>max_) max_ = other.max_;
+}
+
+void StatisticsAccumulator::clear()
+{
+	count_ = 0;
+	mean_ = 0.0;
+	m2_ = 0.0;
+	m3_ = 0.0;
+	min_ = std::numeric_limits<double>::infinity();
+	max_ = -std::numeric_limits<double>::infinity();
+}
+
+double StatisticsAccumulator::mean() const
+{
+	checkNotEmpty("mean");
+	return mean_;
+}
+
+double StatisticsAccumulator::variance() const
+{
+	checkNotEmpty("variance");
+	return m2_ / count_;
+}
+
+double StatisticsAccumulator::sampleVariance() const
+{
+	checkNotEmpty("sample variance", 2);
+	return m2_ / (count_ - 1);
+}
+
+double StatisticsAccumulator::stdev() const
+{
+	checkNotEmpty("standard deviation");
+	return sqrt(m2_ / count_);
+}
+
+double StatisticsAccumulator::min() const
+{
+	checkNotEmpty("minimum");
+	return min_;
+}
+
+double StatisticsAccumulator::max() const
+{
+	checkNotEmpty("maximum");
+	return max_;
+}
+
+double StatisticsAccumulator::skewness() const
+{
+	checkNotEmpty("skewness");
+	if (m2_==0.0) return 0.0;
+
+	return sqrt((double)count_) * m3_ / pow(m2_, 1.5);
+}
+
+void StatisticsAccumulator::checkNotEmpty(QString statistic, qint64 min_count) const
+{
+	if (count_<min_count)
+	{
+		THROW(StatisticsException, "Cannot calculate " + statistic + " of " + QString::number(count_) + " values!");
+	}
+}
+
+CovarianceAccumulator::CovarianceAccumulator()
+{
+	clear();
+}
+
+void CovarianceAccumulator::add(const QVector<double>& x, const QVector<double>& y)
+{
+	if (x.count()!=y.count())
+	{
+		THROW(StatisticsException, "Cannot calculate covariance of data arrays with different length!");
+	}
+
+	for (int i=0; i<x.count(); ++i)
+	{
+		add(x[i], y[i]);
+	}
+}
+
+void CovarianceAccumulator::merge(const CovarianceAccumulator& other)
+{
+	if (other.count_==0) return;
+	if (count_==0)
+	{
+		*this = other;
+		return;
+	}
+
+	const double n_a = count_;
+	const double n_b = other.count_;
+	const double n = n_a + n_b;
+	const double dx = other.mean_x_ - mean_x_;
+	const double dy = other.mean_y_ - mean_y_;
+
+	m2_x_ += other.m2_x_ + dx * dx * n_a * n_b / n;
+	m2_y_ += other.m2_y_ + dy * dy * n_a * n_b / n;
+	c_ += other.c_ + dx * dy * n_a * n_b / n;
+	mean_x_ += dx * n_b / n;
+	mean_y_ += dy * n_b / n;
+	count_ += other.count_;
+}
+
+void CovarianceAccumulator::clear()
+{
+	count_ = 0;
+	mean_x_ = 0.0;
+	mean_y_ = 0.0;
+	m2_x_ = 0.0;
+	m2_y_ = 0.0;
+	c_ = 0.0;
+}
+
+double CovarianceAccumulator::meanX() const
+{
+	checkNotEmpty("mean");
+	return mean_x_;
+}
+
+double CovarianceAccumulator::meanY() const
+{
+	checkNotEmpty("mean");
+	return mean_y_;
+}
+
+double CovarianceAccumulator::varianceX() const
+{
+	checkNotEmpty("variance");
+	return m2_x_ / count_;
+}
+
+double CovarianceAccumulator::varianceY() const
+{
+	checkNotEmpty("variance");
+	return m2_y_ / count_;
+}
+
+double CovarianceAccumulator::covariance() const
+{
+	checkNotEmpty("covariance");
+	return c_ / count_;
+}
+
+double CovarianceAccumulator::correlation() const
+{
+	checkNotEmpty("correlation");
+	if (m2_x_==0.0 || m2_y_==0.0) return std::numeric_limits<double>::quiet_NaN();
+
+	return c_ / sqrt(m2_x_) / sqrt(m2_y_);
+}
+
+void CovarianceAccumulator::checkNotEmpty(QString statistic) const
+{
+	if (count_==0)
+	{
+		THROW(StatisticsException, "Cannot calculate " + statistic + " of empty data arrays!");
+	}
+}
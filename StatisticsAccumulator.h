@@ -0,0 +1,137 @@
+#ifndef STATISTICSACCUMULATOR_H
+#define STATISTICSACCUMULATOR_H
+
+#include "cppCORE_global.h"
+#include <QVector>
+
+/**
+  @brief Single-pass accumulator for count, mean, variance, minimum, maximum and skewness of a data stream.
+
+  Values are added one by one using Welford's update, so the data does not have to be kept in memory and numerical cancellation is avoided.
+  Partial states, e.g. of threads or file chunks, can be combined with merge() (Chan's pairwise update). The result of merging is the same as adding all values to one accumulator, up to floating point rounding.
+  Variance and standard deviation are population statistics (divided by n), like in BasicStatistics.
+*/
+class CPPCORESHARED_EXPORT StatisticsAccumulator
+{
+public:
+	///Default constructor.
+	StatisticsAccumulator();
+
+	///Adds a value.
+	void add(double value)
+	{
+		const double n_old = count_;
+		++count_;
+		const double delta = value - mean_;
+		const double delta_n = delta / count_;
+		const double term = delta * delta_n * n_old;
+		mean_ += delta_n;
+		m3_ += term * delta_n * (count_ - 2) - 3.0 * delta_n * m2_;
+		m2_ += term;
+		if (value<min_) min_ = value;
+		if (value>max_) max_ = value;
+	}
+	///Adds all values of an array.
+	void add(const QVector<double>& data);
+	///Adds the values of another accumulator.
+	void merge(const StatisticsAccumulator& other);
+	///Resets the accumulator to the empty state.
+	void clear();
+
+	///Returns the number of values.
+	qint64 count() const
+	{
+		return count_;
+	}
+	///Returns the mean.
+	double mean() const;
+	///Returns the population variance.
+	double variance() const;
+	///Returns the sample variance (divided by n-1).
+	double sampleVariance() const;
+	///Returns the population standard deviation.
+	double stdev() const;
+	///Returns the minimum.
+	double min() const;
+	///Returns the maximum.
+	double max() const;
+	///Returns the population skewness, or 0 if all values are equal.
+	double skewness() const;
+
+protected:
+	///Throws a StatisticsException if the accumulator is empty.
+	void checkNotEmpty(QString statistic, qint64 min_count=1) const;
+
+	qint64 count_;
+	double mean_;
+	///Sum of squared deviations from the mean
+	double m2_;
+	///Sum of cubed deviations from the mean
+	double m3_;
+	double min_;
+	double max_;
+};
+
+/**
+  @brief Single-pass accumulator for the covariance and correlation of two data streams.
+
+  Like StatisticsAccumulator, partial states can be combined with merge().
+*/
+class CPPCORESHARED_EXPORT CovarianceAccumulator
+{
+public:
+	///Default constructor.
+	CovarianceAccumulator();
+
+	///Adds a value pair.
+	void add(double x, double y)
+	{
+		++count_;
+		const double dx = x - mean_x_;
+		const double dy = y - mean_y_;
+		mean_x_ += dx / count_;
+		mean_y_ += dy / count_;
+		m2_x_ += dx * (x - mean_x_);
+		m2_y_ += dy * (y - mean_y_);
+		c_ += dx * (y - mean_y_);
+	}
+	///Adds all value pairs of two arrays.
+	void add(const QVector<double>& x, const QVector<double>& y);
+	///Adds the value pairs of another accumulator.
+	void merge(const CovarianceAccumulator& other);
+	///Resets the accumulator to the empty state.
+	void clear();
+
+	///Returns the number of value pairs.
+	qint64 count() const
+	{
+		return count_;
+	}
+	///Returns the mean of x.
+	double meanX() const;
+	///Returns the mean of y.
+	double meanY() const;
+	///Returns the population variance of x.
+	double varianceX() const;
+	///Returns the population variance of y.
+	double varianceY() const;
+	///Returns the population covariance.
+	double covariance() const;
+	///Returns the Pearson correlation. Returns NaN if one of the variances is 0.
+	double correlation() const;
+
+protected:
+	///Throws a StatisticsException if the accumulator is empty.
+	void checkNotEmpty(QString statistic) const;
+
+	qint64 count_;
+	double mean_x_;
+	double mean_y_;
+	///Sums of squared deviations from the means
+	double m2_x_;
+	double m2_y_;
+	///Sum of co-deviations from the means
+	double c_;
+};
+
+#endif // STATISTICSACCUMULATOR_H
@@ -0,0 +1,633 @@
+#include "StatisticsKernels.h"
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CPPCORE_X86_KERNELS
+#include <immintrin.h>
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+#define AVX512_TARGET __attribute__((target("avx512f")))
+#endif
+
+namespace
+{
+	///Kernel implementations of one instruction set.
+	struct Kernels
+	{
+		const char* name;
+		double (*sum)(const double*, int);
+		double (*sumSquaredDeviations)(const double*, int, double);
+		void (*sumProducts)(const double*, const double*, int, double, double, double&, double&, double&);
+		double (*dotProduct)(const double*, const double*, int);
+		int (*validSums)(const double*, const double*, int, double&, double&);
+		void (*validRegressionSums)(const double*, const double*, int, double, double&, double&);
+		void (*validMinMax)(const double*, int, double&, double&);
+	};
+
+	///Returns if a value is neither NaN nor infinite.
+	inline bool isValid(double value)
+	{
+		return fabs(value)<=std::numeric_limits<double>::max();
+	}
+
+	/*** scalar kernels (also used for the remainder of the vectorized kernels) ***/
+
+	double scalarSum(const double* data, int n)
+	{
+		double s0 = 0.0;
+		double s1 = 0.0;
+		double s2 = 0.0;
+		double s3 = 0.0;
+		int i = 0;
+		for (; i+4<=n; i+=4)
+		{
+			s0 += data[i];
+			s1 += data[i+1];
+			s2 += data[i+2];
+			s3 += data[i+3];
+		}
+		for (; i<n; ++i)
+		{
+			s0 += data[i];
+		}
+		return (s0 + s1) + (s2 + s3);
+	}
+
+	double scalarSumSquaredDeviations(const double* data, int n, double mean)
+	{
+		double s0 = 0.0;
+		double s1 = 0.0;
+		int i = 0;
+		for (; i+2<=n; i+=2)
+		{
+			const double d0 = data[i] - mean;
+			const double d1 = data[i+1] - mean;
+			s0 += d0 * d0;
+			s1 += d1 * d1;
+		}
+		for (; i<n; ++i)
+		{
+			const double d = data[i] - mean;
+			s0 += d * d;
+		}
+		return s0 + s1;
+	}
+
+	void scalarSumProducts(const double* x, const double* y, int n, double mean_x, double mean_y, double& sxx, double& syy, double& sxy)
+	{
+		sxx = 0.0;
+		syy = 0.0;
+		sxy = 0.0;
+		for (int i=0; i<n; ++i)
+		{
+			const double dx = x[i] - mean_x;
+			const double dy = y[i] - mean_y;
+			sxx += dx * dx;
+			syy += dy * dy;
+			sxy += dx * dy;
+		}
+	}
+
+	double scalarDotProduct(const double* x, const double* y, int n)
+	{
+		double s0 = 0.0;
+		double s1 = 0.0;
+		double s2 = 0.0;
+		double s3 = 0.0;
+		int i = 0;
+		for (; i+4<=n; i+=4)
+		{
+			s0 += x[i] * y[i];
+			s1 += x[i+1] * y[i+1];
+			s2 += x[i+2] * y[i+2];
+			s3 += x[i+3] * y[i+3];
+		}
+		for (; i<n; ++i)
+		{
+			s0 += x[i] * y[i];
+		}
+		return (s0 + s1) + (s2 + s3);
+	}
+
+	int scalarValidSums(const double* x, const double* y, int n, double& sum_x, double& sum_y)
+	{
+		int count = 0;
+		sum_x = 0.0;
+		sum_y = 0.0;
+		for (int i=0; i<n; ++i)
+		{
+			if (isValid(x[i]) && isValid(y[i]))
+			{
+				sum_x += x[i];
+				sum_y += y[i];
+				++count;
+			}
+		}
+		return count;
+	}
+
+	void scalarValidRegressionSums(const double* x, const double* y, int n, double mean_x, double& sxx, double& sxy)
+	{
+		sxx = 0.0;
+		sxy = 0.0;
+		for (int i=0; i<n; ++i)
+		{
+			if (isValid(x[i]) && isValid(y[i]))
+			{
+				const double t = x[i] - mean_x;
+				sxx += t * t;
+				sxy += t * y[i];
+			}
+		}
+	}
+
+	void scalarValidMinMax(const double* data, int n, double& min, double& max)
+	{
+		min = std::numeric_limits<double>::max();
+		max = -std::numeric_limits<double>::max();
+		for (int i=0; i<n; ++i)
+		{
+			if (isValid(data[i]))
+			{
+				min = std::min(min, data[i]);
+				max = std::max(max, data[i]);
+			}
+		}
+	}
+
+#ifdef CPPCORE_X86_KERNELS
+
+	/*** AVX2 kernels (4 doubles per register). The upper register halves are cleared before calling the scalar code for the remainder to avoid AVX-SSE transition penalties. ***/
+
+	AVX2_TARGET inline double horizontalSum(__m256d v)
+	{
+		__m128d sum = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+		return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+	}
+
+	///Returns a mask that is set for values that are neither NaN nor infinite (NaN compares false).
+	AVX2_TARGET inline __m256d validMask(__m256d v)
+	{
+		const __m256d abs = _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+		return _mm256_cmp_pd(abs, _mm256_set1_pd(std::numeric_limits<double>::max()), _CMP_LE_OQ);
+	}
+
+	AVX2_TARGET double avx2Sum(const double* data, int n)
+	{
+		__m256d s0 = _mm256_setzero_pd();
+		__m256d s1 = _mm256_setzero_pd();
+		__m256d s2 = _mm256_setzero_pd();
+		__m256d s3 = _mm256_setzero_pd();
+		int i = 0;
+		for (; i+16<=n; i+=16)
+		{
+			s0 = _mm256_add_pd(s0, _mm256_loadu_pd(data + i));
+			s1 = _mm256_add_pd(s1, _mm256_loadu_pd(data + i + 4));
+			s2 = _mm256_add_pd(s2, _mm256_loadu_pd(data + i + 8));
+			s3 = _mm256_add_pd(s3, _mm256_loadu_pd(data + i + 12));
+		}
+		for (; i+4<=n; i+=4)
+		{
+			s0 = _mm256_add_pd(s0, _mm256_loadu_pd(data + i));
+		}
+		const __m256d sum = _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3));
+		const double result = horizontalSum(sum);
+		_mm256_zeroupper();
+		return result + scalarSum(data + i, n - i);
+	}
+
+	AVX2_TARGET double avx2SumSquaredDeviations(const double* data, int n, double mean)
+	{
+		const __m256d m = _mm256_set1_pd(mean);
+		__m256d s0 = _mm256_setzero_pd();
+		__m256d s1 = _mm256_setzero_pd();
+		__m256d s2 = _mm256_setzero_pd();
+		__m256d s3 = _mm256_setzero_pd();
+		int i = 0;
+		for (; i+16<=n; i+=16)
+		{
+			const __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(data + i), m);
+			const __m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(data + i + 4), m);
+			const __m256d d2 = _mm256_sub_pd(_mm256_loadu_pd(data + i + 8), m);
+			const __m256d d3 = _mm256_sub_pd(_mm256_loadu_pd(data + i + 12), m);
+			s0 = _mm256_fmadd_pd(d0, d0, s0);
+			s1 = _mm256_fmadd_pd(d1, d1, s1);
+			s2 = _mm256_fmadd_pd(d2, d2, s2);
+			s3 = _mm256_fmadd_pd(d3, d3, s3);
+		}
+		for (; i+4<=n; i+=4)
+		{
+			const __m256d d = _mm256_sub_pd(_mm256_loadu_pd(data + i), m);
+			s0 = _mm256_fmadd_pd(d, d, s0);
+		}
+		const __m256d sum = _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3));
+		const double result = horizontalSum(sum);
+		_mm256_zeroupper();
+		return result + scalarSumSquaredDeviations(data + i, n - i, mean);
+	}
+
+	AVX2_TARGET void avx2SumProducts(const double* x, const double* y, int n, double mean_x, double mean_y, double& sxx, double& syy, double& sxy)
+	{
+		const __m256d mx = _mm256_set1_pd(mean_x);
+		const __m256d my = _mm256_set1_pd(mean_y);
+		__m256d xx0 = _mm256_setzero_pd();
+		__m256d xx1 = _mm256_setzero_pd();
+		__m256d yy0 = _mm256_setzero_pd();
+		__m256d yy1 = _mm256_setzero_pd();
+		__m256d xy0 = _mm256_setzero_pd();
+		__m256d xy1 = _mm256_setzero_pd();
+		int i = 0;
+		for (; i+8<=n; i+=8)
+		{
+			const __m256d dx0 = _mm256_sub_pd(_mm256_loadu_pd(x + i), mx);
+			const __m256d dx1 = _mm256_sub_pd(_mm256_loadu_pd(x + i + 4), mx);
+			const __m256d dy0 = _mm256_sub_pd(_mm256_loadu_pd(y + i), my);
+			const __m256d dy1 = _mm256_sub_pd(_mm256_loadu_pd(y + i + 4), my);
+			xx0 = _mm256_fmadd_pd(dx0, dx0, xx0);
+			xx1 = _mm256_fmadd_pd(dx1, dx1, xx1);
+			yy0 = _mm256_fmadd_pd(dy0, dy0, yy0);
+			yy1 = _mm256_fmadd_pd(dy1, dy1, yy1);
+			xy0 = _mm256_fmadd_pd(dx0, dy0, xy0);
+			xy1 = _mm256_fmadd_pd(dx1, dy1, xy1);
+		}
+		const double vector_xx = horizontalSum(_mm256_add_pd(xx0, xx1));
+		const double vector_yy = horizontalSum(_mm256_add_pd(yy0, yy1));
+		const double vector_xy = horizontalSum(_mm256_add_pd(xy0, xy1));
+		_mm256_zeroupper();
+		scalarSumProducts(x + i, y + i, n - i, mean_x, mean_y, sxx, syy, sxy);
+		sxx += vector_xx;
+		syy += vector_yy;
+		sxy += vector_xy;
+	}
+
+	AVX2_TARGET double avx2DotProduct(const double* x, const double* y, int n)
+	{
+		__m256d s0 = _mm256_setzero_pd();
+		__m256d s1 = _mm256_setzero_pd();
+		__m256d s2 = _mm256_setzero_pd();
+		__m256d s3 = _mm256_setzero_pd();
+		int i = 0;
+		for (; i+16<=n; i+=16)
+		{
+			s0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), s0);
+			s1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4), s1);
+			s2 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 8), _mm256_loadu_pd(y + i + 8), s2);
+			s3 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 12), _mm256_loadu_pd(y + i + 12), s3);
+		}
+		for (; i+4<=n; i+=4)
+		{
+			s0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), s0);
+		}
+		const __m256d sum = _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3));
+		const double result = horizontalSum(sum);
+		_mm256_zeroupper();
+		return result + scalarDotProduct(x + i, y + i, n - i);
+	}
+
+	AVX2_TARGET int avx2ValidSums(const double* x, const double* y, int n, double& sum_x, double& sum_y)
+	{
+		const __m256d one = _mm256_set1_pd(1.0);
+		__m256d sx = _mm256_setzero_pd();
+		__m256d sy = _mm256_setzero_pd();
+		__m256d count = _mm256_setzero_pd();
+		int i = 0;
+		for (; i+4<=n; i+=4)
+		{
+			const __m256d vx = _mm256_loadu_pd(x + i);
+			const __m256d vy = _mm256_loadu_pd(y + i);
+			const __m256d valid = _mm256_and_pd(validMask(vx), validMask(vy));
+			sx = _mm256_add_pd(sx, _mm256_and_pd(valid, vx));
+			sy = _mm256_add_pd(sy, _mm256_and_pd(valid, vy));
+			count = _mm256_add_pd(count, _mm256_and_pd(valid, one));
+		}
+		const double vector_x = horizontalSum(sx);
+		const double vector_y = horizontalSum(sy);
+		const int vector_count = (int)horizontalSum(count);
+		_mm256_zeroupper();
+		const int rest = scalarValidSums(x + i, y + i, n - i, sum_x, sum_y);
+		sum_x += vector_x;
+		sum_y += vector_y;
+		return rest + vector_count;
+	}
+
+	AVX2_TARGET void avx2ValidRegressionSums(const double* x, const double* y, int n, double mean_x, double& sxx, double& sxy)
+	{
+		const __m256d mx = _mm256_set1_pd(mean_x);
+		__m256d xx = _mm256_setzero_pd();
+		__m256d xy = _mm256_setzero_pd();
+		int i = 0;
+		for (; i+4<=n; i+=4)
+		{
+			const __m256d vx = _mm256_loadu_pd(x + i);
+			const __m256d vy = _mm256_loadu_pd(y + i);
+			const __m256d valid = _mm256_and_pd(validMask(vx), validMask(vy));
+			const __m256d t = _mm256_and_pd(valid, _mm256_sub_pd(vx, mx));
+			xx = _mm256_fmadd_pd(t, t, xx);
+			xy = _mm256_fmadd_pd(t, _mm256_and_pd(valid, vy), xy);
+		}
+		const double vector_xx = horizontalSum(xx);
+		const double vector_xy = horizontalSum(xy);
+		_mm256_zeroupper();
+		scalarValidRegressionSums(x + i, y + i, n - i, mean_x, sxx, sxy);
+		sxx += vector_xx;
+		sxy += vector_xy;
+	}
+
+	AVX2_TARGET void avx2ValidMinMax(const double* data, int n, double& min, double& max)
+	{
+		const __m256d largest = _mm256_set1_pd(std::numeric_limits<double>::max());
+		const __m256d smallest = _mm256_set1_pd(-std::numeric_limits<double>::max());
+		__m256d vmin = largest;
+		__m256d vmax = smallest;
+		int i = 0;
+		for (; i+4<=n; i+=4)
+		{
+			const __m256d v = _mm256_loadu_pd(data + i);
+			const __m256d valid = validMask(v);
+			vmin = _mm256_min_pd(vmin, _mm256_blendv_pd(largest, v, valid));
+			vmax = _mm256_max_pd(vmax, _mm256_blendv_pd(smallest, v, valid));
+		}
+		double lanes_min[4];
+		double lanes_max[4];
+		_mm256_storeu_pd(lanes_min, vmin);
+		_mm256_storeu_pd(lanes_max, vmax);
+		_mm256_zeroupper();
+
+		scalarValidMinMax(data + i, n - i, min, max);
+		for (int l=0; l<4; ++l)
+		{
+			min = std::min(min, lanes_min[l]);
+			max = std::max(max, lanes_max[l]);
+		}
+	}
+
+	/*** AVX-512 kernels (8 doubles per register, invalid values are excluded with mask registers) ***/
+
+	///Sums the lanes of a register (via memory, the reduce intrinsics trigger false-positive warnings in some GCC versions).
+	AVX512_TARGET inline double horizontalSum512(__m512d v)
+	{
+		double lanes[8];
+		_mm512_storeu_pd(lanes, v);
+		return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+	}
+
+	AVX512_TARGET inline __mmask8 validMask512(__m512d v)
+	{
+		return _mm512_cmp_pd_mask(_mm512_abs_pd(v), _mm512_set1_pd(std::numeric_limits<double>::max()), _CMP_LE_OQ);
+	}
+
+	AVX512_TARGET double avx512Sum(const double* data, int n)
+	{
+		__m512d s0 = _mm512_setzero_pd();
+		__m512d s1 = _mm512_setzero_pd();
+		__m512d s2 = _mm512_setzero_pd();
+		__m512d s3 = _mm512_setzero_pd();
+		int i = 0;
+		for (; i+32<=n; i+=32)
+		{
+			s0 = _mm512_add_pd(s0, _mm512_loadu_pd(data + i));
+			s1 = _mm512_add_pd(s1, _mm512_loadu_pd(data + i + 8));
+			s2 = _mm512_add_pd(s2, _mm512_loadu_pd(data + i + 16));
+			s3 = _mm512_add_pd(s3, _mm512_loadu_pd(data + i + 24));
+		}
+		for (; i+8<=n; i+=8)
+		{
+			s0 = _mm512_add_pd(s0, _mm512_loadu_pd(data + i));
+		}
+		const __m512d sum = _mm512_add_pd(_mm512_add_pd(s0, s1), _mm512_add_pd(s2, s3));
+		const double result = horizontalSum512(sum);
+		_mm256_zeroupper();
+		return result + scalarSum(data + i, n - i);
+	}
+
+	AVX512_TARGET double avx512SumSquaredDeviations(const double* data, int n, double mean)
+	{
+		const __m512d m = _mm512_set1_pd(mean);
+		__m512d s0 = _mm512_setzero_pd();
+		__m512d s1 = _mm512_setzero_pd();
+		__m512d s2 = _mm512_setzero_pd();
+		__m512d s3 = _mm512_setzero_pd();
+		int i = 0;
+		for (; i+32<=n; i+=32)
+		{
+			const __m512d d0 = _mm512_sub_pd(_mm512_loadu_pd(data + i), m);
+			const __m512d d1 = _mm512_sub_pd(_mm512_loadu_pd(data + i + 8), m);
+			const __m512d d2 = _mm512_sub_pd(_mm512_loadu_pd(data + i + 16), m);
+			const __m512d d3 = _mm512_sub_pd(_mm512_loadu_pd(data + i + 24), m);
+			s0 = _mm512_fmadd_pd(d0, d0, s0);
+			s1 = _mm512_fmadd_pd(d1, d1, s1);
+			s2 = _mm512_fmadd_pd(d2, d2, s2);
+			s3 = _mm512_fmadd_pd(d3, d3, s3);
+		}
+		for (; i+8<=n; i+=8)
+		{
+			const __m512d d = _mm512_sub_pd(_mm512_loadu_pd(data + i), m);
+			s0 = _mm512_fmadd_pd(d, d, s0);
+		}
+		const __m512d sum = _mm512_add_pd(_mm512_add_pd(s0, s1), _mm512_add_pd(s2, s3));
+		const double result = horizontalSum512(sum);
+		_mm256_zeroupper();
+		return result + scalarSumSquaredDeviations(data + i, n - i, mean);
+	}
+
+	AVX512_TARGET void avx512SumProducts(const double* x, const double* y, int n, double mean_x, double mean_y, double& sxx, double& syy, double& sxy)
+	{
+		const __m512d mx = _mm512_set1_pd(mean_x);
+		const __m512d my = _mm512_set1_pd(mean_y);
+		__m512d xx0 = _mm512_setzero_pd();
+		__m512d xx1 = _mm512_setzero_pd();
+		__m512d yy0 = _mm512_setzero_pd();
+		__m512d yy1 = _mm512_setzero_pd();
+		__m512d xy0 = _mm512_setzero_pd();
+		__m512d xy1 = _mm512_setzero_pd();
+		int i = 0;
+		for (; i+16<=n; i+=16)
+		{
+			const __m512d dx0 = _mm512_sub_pd(_mm512_loadu_pd(x + i), mx);
+			const __m512d dx1 = _mm512_sub_pd(_mm512_loadu_pd(x + i + 8), mx);
+			const __m512d dy0 = _mm512_sub_pd(_mm512_loadu_pd(y + i), my);
+			const __m512d dy1 = _mm512_sub_pd(_mm512_loadu_pd(y + i + 8), my);
+			xx0 = _mm512_fmadd_pd(dx0, dx0, xx0);
+			xx1 = _mm512_fmadd_pd(dx1, dx1, xx1);
+			yy0 = _mm512_fmadd_pd(dy0, dy0, yy0);
+			yy1 = _mm512_fmadd_pd(dy1, dy1, yy1);
+			xy0 = _mm512_fmadd_pd(dx0, dy0, xy0);
+			xy1 = _mm512_fmadd_pd(dx1, dy1, xy1);
+		}
+		const double vector_xx = horizontalSum512(_mm512_add_pd(xx0, xx1));
+		const double vector_yy = horizontalSum512(_mm512_add_pd(yy0, yy1));
+		const double vector_xy = horizontalSum512(_mm512_add_pd(xy0, xy1));
+		_mm256_zeroupper();
+		scalarSumProducts(x + i, y + i, n - i, mean_x, mean_y, sxx, syy, sxy);
+		sxx += vector_xx;
+		syy += vector_yy;
+		sxy += vector_xy;
+	}
+
+	AVX512_TARGET double avx512DotProduct(const double* x, const double* y, int n)
+	{
+		__m512d s0 = _mm512_setzero_pd();
+		__m512d s1 = _mm512_setzero_pd();
+		__m512d s2 = _mm512_setzero_pd();
+		__m512d s3 = _mm512_setzero_pd();
+		int i = 0;
+		for (; i+32<=n; i+=32)
+		{
+			s0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), s0);
+			s1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8), s1);
+			s2 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 16), _mm512_loadu_pd(y + i + 16), s2);
+			s3 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 24), _mm512_loadu_pd(y + i + 24), s3);
+		}
+		for (; i+8<=n; i+=8)
+		{
+			s0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), s0);
+		}
+		const __m512d sum = _mm512_add_pd(_mm512_add_pd(s0, s1), _mm512_add_pd(s2, s3));
+		const double result = horizontalSum512(sum);
+		_mm256_zeroupper();
+		return result + scalarDotProduct(x + i, y + i, n - i);
+	}
+
+	AVX512_TARGET int avx512ValidSums(const double* x, const double* y, int n, double& sum_x, double& sum_y)
+	{
+		__m512d sx = _mm512_setzero_pd();
+		__m512d sy = _mm512_setzero_pd();
+		int count = 0;
+		int i = 0;
+		for (; i+8<=n; i+=8)
+		{
+			const __m512d vx = _mm512_loadu_pd(x + i);
+			const __m512d vy = _mm512_loadu_pd(y + i);
+			const __mmask8 valid = validMask512(vx) & validMask512(vy);
+			sx = _mm512_mask_add_pd(sx, valid, sx, vx);
+			sy = _mm512_mask_add_pd(sy, valid, sy, vy);
+			count += __builtin_popcount(valid);
+		}
+		const double vector_x = horizontalSum512(sx);
+		const double vector_y = horizontalSum512(sy);
+		_mm256_zeroupper();
+		count += scalarValidSums(x + i, y + i, n - i, sum_x, sum_y);
+		sum_x += vector_x;
+		sum_y += vector_y;
+		return count;
+	}
+
+	AVX512_TARGET void avx512ValidRegressionSums(const double* x, const double* y, int n, double mean_x, double& sxx, double& sxy)
+	{
+		const __m512d mx = _mm512_set1_pd(mean_x);
+		__m512d xx = _mm512_setzero_pd();
+		__m512d xy = _mm512_setzero_pd();
+		int i = 0;
+		for (; i+8<=n; i+=8)
+		{
+			const __m512d vx = _mm512_loadu_pd(x + i);
+			const __m512d vy = _mm512_loadu_pd(y + i);
+			const __mmask8 valid = validMask512(vx) & validMask512(vy);
+			const __m512d t = _mm512_maskz_sub_pd(valid, vx, mx);
+			xx = _mm512_fmadd_pd(t, t, xx);
+			xy = _mm512_fmadd_pd(t, _mm512_maskz_mov_pd(valid, vy), xy);
+		}
+		const double vector_xx = horizontalSum512(xx);
+		const double vector_xy = horizontalSum512(xy);
+		_mm256_zeroupper();
+		scalarValidRegressionSums(x + i, y + i, n - i, mean_x, sxx, sxy);
+		sxx += vector_xx;
+		sxy += vector_xy;
+	}
+
+	AVX512_TARGET void avx512ValidMinMax(const double* data, int n, double& min, double& max)
+	{
+		__m512d vmin = _mm512_set1_pd(std::numeric_limits<double>::max());
+		__m512d vmax = _mm512_set1_pd(-std::numeric_limits<double>::max());
+		int i = 0;
+		for (; i+8<=n; i+=8)
+		{
+			const __m512d v = _mm512_loadu_pd(data + i);
+			const __mmask8 valid = validMask512(v);
+			vmin = _mm512_mask_min_pd(vmin, valid, vmin, v);
+			vmax = _mm512_mask_max_pd(vmax, valid, vmax, v);
+		}
+		double lanes_min[8];
+		double lanes_max[8];
+		_mm512_storeu_pd(lanes_min, vmin);
+		_mm512_storeu_pd(lanes_max, vmax);
+		_mm256_zeroupper();
+
+		scalarValidMinMax(data + i, n - i, min, max);
+		for (int l=0; l<8; ++l)
+		{
+			min = std::min(min, lanes_min[l]);
+			max = std::max(max, lanes_max[l]);
+		}
+	}
+
+#endif
+
+	///Selects the kernels for the instruction set of the CPU.
+	Kernels selectKernels()
+	{
+#ifdef CPPCORE_X86_KERNELS
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f"))
+		{
+			Kernels kernels = {"AVX-512", avx512Sum, avx512SumSquaredDeviations, avx512SumProducts, avx512DotProduct, avx512ValidSums, avx512ValidRegressionSums, avx512ValidMinMax};
+			return kernels;
+		}
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		{
+			Kernels kernels = {"AVX2", avx2Sum, avx2SumSquaredDeviations, avx2SumProducts, avx2DotProduct, avx2ValidSums, avx2ValidRegressionSums, avx2ValidMinMax};
+			return kernels;
+		}
+#endif
+		Kernels kernels = {"scalar", scalarSum, scalarSumSquaredDeviations, scalarSumProducts, scalarDotProduct, scalarValidSums, scalarValidRegressionSums, scalarValidMinMax};
+		return kernels;
+	}
+
+	///Returns the kernels (selected once, thread-safe).
+	const Kernels& kernels()
+	{
+		static const Kernels selected = selectKernels();
+		return selected;
+	}
+}
+
+double StatisticsKernels::sum(const double* data, int n)
+{
+	return kernels().sum(data, n);
+}
+
+double StatisticsKernels::sumSquaredDeviations(const double* data, int n, double mean)
+{
+	return kernels().sumSquaredDeviations(data, n, mean);
+}
+
+void StatisticsKernels::sumProducts(const double* x, const double* y, int n, double mean_x, double mean_y, double& sxx, double& syy, double& sxy)
+{
+	kernels().sumProducts(x, y, n, mean_x, mean_y, sxx, syy, sxy);
+}
+
+double StatisticsKernels::dotProduct(const double* x, const double* y, int n)
+{
+	return kernels().dotProduct(x, y, n);
+}
+
+int StatisticsKernels::validSums(const double* x, const double* y, int n, double& sum_x, double& sum_y)
+{
+	return kernels().validSums(x, y, n, sum_x, sum_y);
+}
+
+void StatisticsKernels::validRegressionSums(const double* x, const double* y, int n, double mean_x, double& sxx, double& sxy)
+{
+	kernels().validRegressionSums(x, y, n, mean_x, sxx, sxy);
+}
+
+void StatisticsKernels::validMinMax(const double* data, int n, double& min, double& max)
+{
+	kernels().validMinMax(data, n, min, max);
+}
+
+QString StatisticsKernels::instructionSet()
+{
+	return kernels().name;
+}
@@ -0,0 +1,42 @@
+#ifndef STATISTICSKERNELS_H
+#define STATISTICSKERNELS_H
+
+#include "cppCORE_global.h"
+#include <QString>
+
+/**
+  @brief Vectorized reduction kernels used by BasicStatistics.
+
+  On x86 processors compiled with GCC or Clang, the kernels are implemented with AVX-512 and AVX2/FMA intrinsics. The instruction set is selected once at run-time.
+  On other processors/compilers, or if the CPU does not support AVX2, scalar code with several independent accumulators is used.
+  All kernels use several partial sums, so the results differ from a sequential loop by floating point rounding only (relative difference typically below 1e-12, at most n times the machine epsilon).
+  The 'valid' kernels skip invalid values, i.e. NaN and infinite values (see BasicStatistics::isValidFloat). They are masked out, so there is no branch per element.
+  The other kernels do not check the values, i.e. NaN and infinite values propagate to the result.
+*/
+class CPPCORESHARED_EXPORT StatisticsKernels
+{
+public:
+	///Returns the sum of the data (invalid values are not skipped).
+	static double sum(const double* data, int n);
+	///Returns the sum of squared deviations from @p mean (invalid values are not skipped).
+	static double sumSquaredDeviations(const double* data, int n, double mean);
+	///Calculates the sums of squared deviations and the sum of co-deviations of two arrays from their means (invalid values are not skipped).
+	static void sumProducts(const double* x, const double* y, int n, double mean_x, double mean_y, double& sxx, double& syy, double& sxy);
+	///Returns the dot product of two arrays (invalid values are not skipped).
+	static double dotProduct(const double* x, const double* y, int n);
+	///Calculates the sums of pairs where both values are valid (invalid pairs are skipped). Returns the number of valid pairs.
+	static int validSums(const double* x, const double* y, int n, double& sum_x, double& sum_y);
+	///Calculates the sum of squared deviations of x from @p mean_x and the sum of y weighted by the deviation of x, for pairs where both values are valid.
+	static void validRegressionSums(const double* x, const double* y, int n, double mean_x, double& sxx, double& sxy);
+	///Calculates minimum and maximum of the valid values. If there is no valid value, the largest double value is returned as minimum and its negative as maximum.
+	static void validMinMax(const double* data, int n, double& min, double& max);
+
+	///Returns the instruction set used for the kernels ('AVX-512', 'AVX2' or 'scalar').
+	static QString instructionSet();
+
+protected:
+	///Constructor declared away.
+	StatisticsKernels();
+};
+
+#endif // STATISTICSKERNELS_H
@@ -32,7 +32,23 @@ SOURCES += \
     ScatterPlot.cpp \
     BarPlot.cpp \
 	Histogram.cpp \
-    IntervalTree.cpp
+    IntervalTree.cpp \
+    Parallel.cpp \
+    IntervalIndex.cpp \
+    IntervalAlgebra.cpp \
+    IntervalCoverage.cpp \
+    DynamicIntervalTree.cpp \
+    IntervalAnnotator.cpp \
+    IntervalSweep.cpp \
+    CoverageSet.cpp \
+    StatisticsAccumulator.cpp \
+    StatisticsKernels.cpp \
+    QuantileSketch.cpp \
+    ParallelStatistics.cpp \
+    CorrelationMatrix.cpp \
+    RollingStatistics.cpp \
+    RandomGenerator.cpp \
+    Resampling.cpp
 
 HEADERS += ToolBase.h \
     Exceptions.h \
@@ -47,5 +63,23 @@ HEADERS += ToolBase.h \
     ScatterPlot.h \
     BarPlot.h \
 	Histogram.h \
-    IntervalTree.h
+    IntervalTree.h \
+    Parallel.h \
+    IntervalIndex.h \
+    IntervalAlgebra.h \
+    IntervalCoverage.h \
+    DynamicIntervalTree.h \
+    IntervalAnnotator.h \
+    IntervalSweep.h \
+    IntervalBinIndex.h \
+    CoverageSet.h \
+    StatisticsAccumulator.h \
+    StatisticsKernels.h \
+    QuantileSketch.h \
+    ParallelStatistics.h \
+    RangeStatistics.h \
+    CorrelationMatrix.h \
+    RollingStatistics.h \
+    RandomGenerator.h \
+    Resampling.h
 	
\ No newline at end of file
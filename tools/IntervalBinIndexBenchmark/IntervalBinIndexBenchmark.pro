@@ -0,0 +1,23 @@
+#c++11 support
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+#base settings
+QT       -= gui
+TEMPLATE = app
+TARGET = IntervalBinIndexBenchmark
+
+#enable O3 optimization
+QMAKE_CXXFLAGS_RELEASE -= -O
+QMAKE_CXXFLAGS_RELEASE -= -O1
+QMAKE_CXXFLAGS_RELEASE -= -O2
+QMAKE_CXXFLAGS_RELEASE *= -O3
+
+#the benchmark compiles the few library sources it needs, so it does not depend on the library build
+DEFINES += CPPCORE_LIBRARY
+INCLUDEPATH += ../..
+
+SOURCES += main.cpp \
+    ../../Exceptions.cpp \
+    ../../IntervalTree.cpp \
+    ../../RandomGenerator.cpp
@@ -0,0 +1,81 @@
+#include "IntervalTree.h"
+#include "IntervalBinIndex.h"
+#include "RandomGenerator.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+//Compares build and query times of IntervalBinIndex and IntervalTree on random intervals of a 250Mb sequence.
+//Usage: IntervalBinIndexBenchmark [intervals] [queries]
+
+namespace
+{
+	const int SEQUENCE_LENGTH = 250000000;
+
+	///Runs one scenario: @p long_fraction of the intervals have a length of 0.1-2Mb, the others 100-5100bp.
+	void run(QTextStream& out, int interval_count, int query_count, double long_fraction, int query_length)
+	{
+		RandomGenerator rng(7);
+		QVector<Interval> intervals;
+		intervals.reserve(interval_count);
+		std::list<int> indices;
+		for (int i=0; i<interval_count; ++i)
+		{
+			const int start = rng.integer(0, SEQUENCE_LENGTH-1);
+			const int length = rng.uniform()<long_fraction ? rng.integer(100000, 2100000) : rng.integer(100, 5100);
+			intervals.append(Interval(start, start + length, i));
+			indices.push_back(i);
+		}
+		QVector<int> query_starts(query_count);
+		rng.fillInteger(query_starts.data(), query_count, 0, SEQUENCE_LENGTH-1);
+
+		QElapsedTimer timer;
+		timer.start();
+		IntervalTree<QVector<Interval> > tree(intervals, indices);
+		const qint64 tree_build = timer.restart();
+		IntervalBinIndex<QVector<Interval> > bins(intervals, indices);
+		const qint64 bins_build = timer.restart();
+
+		//queries
+		QVector<int> matches;
+		qint64 tree_matches = 0;
+		timer.restart();
+		foreach(int start, query_starts)
+		{
+			tree.overlappingIntervals(start, start + query_length, matches);
+			tree_matches += matches.count();
+		}
+		const qint64 tree_query = timer.restart();
+		qint64 bins_matches = 0;
+		foreach(int start, query_starts)
+		{
+			bins.overlappingIntervals(start, start + query_length, matches);
+			bins_matches += matches.count();
+		}
+		const qint64 bins_query = timer.restart();
+
+		out << "intervals: " << interval_count << " (" << (100.0 * long_fraction) << "% long), queries: " << query_count << " of " << query_length << "bp" << endl;
+		out << "  build [ms]:  IntervalTree " << tree_build << ", IntervalBinIndex " << bins_build << endl;
+		out << "  query [ms]:  IntervalTree " << tree_query << ", IntervalBinIndex " << bins_query << endl;
+		if (tree_matches!=bins_matches)
+		{
+			out << "  ERROR: match counts differ (" << tree_matches << " vs. " << bins_matches << ")" << endl;
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	const QStringList args = app.arguments();
+	const int interval_count = args.count()>1 ? args[1].toInt() : 1000000;
+	const int query_count = args.count()>2 ? args[2].toInt() : 1000000;
+
+	QTextStream out(stdout);
+	run(out, interval_count, query_count, 0.0, 100);
+	run(out, interval_count, query_count, 0.01, 100);
+	run(out, interval_count, query_count, 0.1, 100);
+	run(out, interval_count, query_count, 0.0, 10000);
+
+	return 0;
+}